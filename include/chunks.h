@@ -0,0 +1,12 @@
+#ifndef CHUNKS_H
+#define CHUNKS_H
+
+#include "types.h"
+#include "common.h"
+
+void init_map_chunks(World* world, SDL_Renderer* renderer);
+void invalidate_map_chunks(World* world);
+void render_map_chunks(SDL_Renderer* renderer, World* world, Camera* camera);
+void free_map_chunks(World* world);
+
+#endif
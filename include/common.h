@@ -34,24 +34,40 @@
 // Defines the transitional range for fading visibility in FOV (650 pixels)
 #define FOV_TRANSITIONAL_RANGE 650.0f
 #define FOV_CIRCLE_TRANSITIONAL_RANGE (FOV_CIRCLE_R - 10.0f)
+// Defines the extra border drawn around the FOV mask so small camera moves can reuse it (64 pixels)
+#define FOV_MASK_MARGIN 64
 // Defines the alpha value for grayed-out areas in FOV (150 for partial transparency)
 #define FOV_GRAY_ALPHA 150
 // Defines the player's rotation speed in degrees per second (270 degrees/second for a 180-degree turn in 0.66 seconds)
 #define PLAYER_ROTATION_SPEED 270.0f
 // Defines the maximum rotation per fixed update for the player (based on rotation speed and fixed delta time)
-#define MAX_PLAYER_ROTATION (PLAYER_ROTATION_SPEED * FIXED_DT * 1.0f)
+#define MAX_PLAYER_ROTATION (PLAYER_ROTATION_SPEED * fixed_dt * 1.0f)
 // Number of rays for smooth circle approximation (higher = smoother, but 360 is ample for 90-degree FOV)
 #define FOV_RAY_COUNT 128
+// Defines the maximum number of rays in one visibility polygon (1024 rays)
+#define FOV_MAX_RAYS 1024
+// Defines the largest gap allowed between the visibility polygon and the true FOV arc in pixels (1 pixel)
+#define FOV_ARC_TOLERANCE 1.0f
+// Defines the angular offset of the rays cast just past each wall corner in radians
+#define FOV_CORNER_EPSILON 0.0005f
+// Defines the number of bisection steps used to find where a wall face leaves the FOV range (10 steps)
+#define FOV_REFINE_STEPS 10
+// Defines the downscale factor of the software-rasterised FOV mask, upscaled with linear filtering (2 = half resolution)
+#define FOV_SOFT_SCALE 2
 
-// Defines the maximum number of bullets that can exist at once (200 bullets)
+// Defines the maximum number of bullets that can exist at once (200 bullets, raised by the collision bench)
+#ifndef MAX_BULLETS
 #define MAX_BULLETS 200
+#endif
 // Defines the speed of bullets in pixels per second (1024 pixels/second)
 #define BULLET_SPEED 1024.0f
 // Defines the lifetime of bullets in seconds (0.5 seconds)
 #define BULLET_LIFETIME 0.5f
 
-// Defines the maximum number of enemies that can exist at once (400 enemies)
+// Defines the maximum number of enemies that can exist at once (400 enemies, raised by the headless bench)
+#ifndef MAX_ENEMIES
 #define MAX_ENEMIES 400
+#endif
 // Defines the default health points for enemies (50 HP)
 #define ENEMY_HP 50.0f
 // Defines the time before an enemy respawns after being defeated (10 seconds)
@@ -80,15 +96,96 @@
 #define SHOOT_COOLDOWN 0.5f
 // Defines the interval for enemy decision-making in seconds (1 second)
 #define DECISION_INTERVAL 1.0f
+// Defines the side length of a cover index bin in tiles (8x8 tiles per bin)
+#define COVER_BIN_TILES 8
+// Defines the number of cover index bins along each map side (64 / 8 = 8 bins)
+#define COVER_BINS (MAP_SIZE / COVER_BIN_TILES)
+// Defines the side length of a baked map chunk texture in pixels (512 pixels = 16 tiles)
+#define MAP_CHUNK_SIZE 512
+// Defines the number of map chunks along the world's width and height (2048 / 512 = 4 chunks)
+#define MAP_CHUNKS_X ((WORLD_W + MAP_CHUNK_SIZE - 1) / MAP_CHUNK_SIZE)
+#define MAP_CHUNKS_Y ((WORLD_H + MAP_CHUNK_SIZE - 1) / MAP_CHUNK_SIZE)
+// Defines the width of the sprite atlas in pixels (256 pixels)
+#define SPRITE_ATLAS_W 256
+// Defines the transparent gap kept around each sprite in the atlas so neighbours never bleed in (1 pixel)
+#define SPRITE_ATLAS_PADDING 1
+// Defines the maximum number of sprites in one batched draw call (1024 sprites)
+#define SPRITE_BATCH_MAX 1024
+// Defines the first and one past the last character cached in the glyph atlas (printable ASCII, ' ' to '~')
+#define GLYPH_FIRST 32
+#define GLYPH_END 127
+#define GLYPH_COUNT (GLYPH_END - GLYPH_FIRST)
+// Defines the width of the glyph atlas in pixels (512 pixels)
+#define GLYPH_ATLAS_W 512
+// Defines the transparent gap kept around each glyph in the atlas (1 pixel)
+#define GLYPH_ATLAS_PADDING 1
+// Defines the maximum number of glyphs in one batched text draw call (2048 glyphs)
+#define TEXT_BATCH_MAX 2048
+// Defines the length of the simulation status line carried in each render snapshot (64 characters)
+#define SNAPSHOT_HUD_LENGTH 64
+// Defines the flag set on the ready snapshot slot until the renderer takes it
+#define SNAPSHOT_FRESH 4
+// Defines the number of frames the profiler keeps for its overlay and statistics (240 frames)
+#define PROFILE_HISTORY 240
+// Defines the vertical scale of the profiler's frame-time graph in pixels per millisecond (4 pixels)
+#define PROFILE_GRAPH_SCALE 4.0f
+// Defines the height of the profiler's frame-time graph in pixels (100 pixels, 25 ms)
+#define PROFILE_GRAPH_H 100
+// Defines the number of events the tracer buffers before dropping new ones (262144 events, about 20 MB)
+#define TRACE_MAX_EVENTS 262144
+// Defines the maximum number of named integer arguments on one trace event (3 arguments)
+#define TRACE_MAX_ARGS 3
+// Defines the maximum number of threads the tracer names in its output (8 threads)
+#define TRACE_MAX_THREADS 8
+// Defines the file the tracer writes when no other is given
+#define TRACE_DEFAULT_PATH "trace.json"
+// Defines the log2 of the number of linear sub-buckets per power of two in the timing histograms (32 sub-buckets, about 3% precision)
+#define TIMING_SUB_BITS 5
+// Defines the number of powers of two the timing histograms cover above their linear range (20, up to about 67 seconds in microseconds)
+#define TIMING_MAX_SHIFT 20
+// Defines the number of buckets in each timing histogram (64 exact microsecond values, then 32 per power of two)
+#define TIMING_BUCKETS ((2 << TIMING_SUB_BITS) + TIMING_MAX_SHIFT * (1 << TIMING_SUB_BITS))
+// Defines the number of textures the memory registry can track at once (256 textures)
+#define MEMORY_MAX_TEXTURES 256
+// Defines the number of map rows the influence map refreshes per fixed update (16 rows, full refresh every 4 updates)
+#define INFLUENCE_ROWS_PER_TICK 16
+// Defines the share of the gap to the propagated influence closed per refresh (0.5)
+#define INFLUENCE_MOMENTUM 0.5f
+// Defines how much threat and density carry over from one tile to the next (0.75)
+#define INFLUENCE_FALLOFF 0.75f
+// Defines how much the last known player position carries over from one tile to the next (0.9)
+#define INFLUENCE_MEMORY_FALLOFF 0.9f
+// Defines how long the last known player position stays in memory in seconds (5 seconds, same as searching)
+#define INFLUENCE_MEMORY_TIME 5.0f
+// Defines the cover score penalty per unit of enemy density at a cover point in pixels (64 pixels)
+#define COVER_DENSITY_PENALTY 64.0f
+// Defines the threat level above which enemies avoid wandering into a tile (0.5)
+#define THREAT_AVOID_LEVEL 0.5f
+// Defines the last-seen level above which idle enemies join the search (0.25)
+#define LAST_SEEN_ALERT_LEVEL 0.25f
 
-// Defines the fixed time step for physics updates in seconds (1/60 seconds for 60 Hz updates)
+// Defines the default fixed time step for physics updates in seconds (1/60 seconds for 60 Hz updates)
 #define FIXED_DT (1.0f / 60.0f)
+// Defines the range of simulation rates the fixed time step can be set to at runtime (10-240 Hz)
+#define SIM_RATE_MIN 10
+#define SIM_RATE_MAX 240
 // Defines the interval for updating the FPS display in seconds (1 second)
 #define FPS_UPDATE_INTERVAL 1.0f
 // Defines the target frames per second for the game (144 FPS)
 #define TARGET_FPS 144.0f
 // Defines the target frame time in milliseconds (1000/144 ≈ 6.944 ms)
 #define TARGET_FRAME_TIME (1000.0f / TARGET_FPS)
+// Defines how long before a deadline the frame pacer stops sleeping and spins instead, covering SDL_Delay's oversleep (2 ms)
+#define PACING_SPIN_MS 2.0
+// Defines the shortest frame time vsync can give, faster than any display refreshes (2 ms, 500 Hz)
+#define PACING_VSYNC_MIN_MS 2.0
+// Defines how many frames in a row must come in under PACING_VSYNC_MIN_MS before vsync is taken to be ignored (30 frames)
+#define PACING_VSYNC_FAST_FRAMES 30
+// Defines the default number of fixed updates run in one frame before the rest of the backlog is dropped (5 updates)
+#define MAX_SIM_STEPS_DEFAULT 5
+// Defines the range the per-frame fixed update limit can be set to at runtime (1-60 updates)
+#define MAX_SIM_STEPS_MIN 1
+#define MAX_SIM_STEPS_MAX 60
 
 // Defines the maximum length of a console command in characters (256 characters)
 #define MAX_COMMAND_LENGTH 256
@@ -98,8 +195,8 @@
 #define MESSAGE_DURATION 30.0f
 // Defines the maximum number of commands stored in the console history (50 commands)
 #define MAX_HISTORY 50
-// Defines the number of available console commands (2 commands)
-#define NUM_COMMANDS 2
+// Defines the number of available console commands (9 commands)
+#define NUM_COMMANDS 9
 // Defines the interval for the console cursor blink cycle in seconds (2 seconds)
 #define CURSOR_BLINK_INTERVAL 2.0f
 
@@ -109,5 +206,7 @@
 #define MA_PI (3.1415926535897932846f)
 
 extern 	SDL_Texture* fov_mask;
+extern float fixed_dt; // Current fixed time step in seconds, see set_sim_rate
+extern int max_sim_steps; // Current limit on fixed updates per frame, see set_max_sim_steps
 
 #endif
@@ -0,0 +1,13 @@
+#ifndef COVER_H
+#define COVER_H
+
+#include "types.h"
+#include "common.h"
+
+void build_cover_index(World* world);
+void update_cover_index(World* world);
+void update_cover_cache(World* world, int player_x, int player_y);
+void get_cover_bin_range(float x, float y, float radius, int* min_bx, int* min_by, int* max_bx, int* max_by);
+void free_cover_index(World* world);
+
+#endif
@@ -0,0 +1,9 @@
+#ifndef CULL_H
+#define CULL_H
+
+#include "types.h"
+#include "common.h"
+
+bool get_view_tile_range(Camera* camera, float margin, int* min_tx, int* min_ty, int* max_tx, int* max_ty);
+
+#endif
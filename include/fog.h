@@ -0,0 +1,12 @@
+#ifndef FOG_H
+#define FOG_H
+
+#include "types.h"
+#include "common.h"
+
+void clear_fog(Uint32* pixels, int pitch, int w, int h);
+void rasterize_fog_polygon(Uint32* pixels, int pitch, int w, int h, float scale, float cx, float cy,
+                           const float* cos_a, const float* sin_a, const float* dist, int rays,
+                           float fade_start, float fade_end);
+
+#endif
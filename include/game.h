@@ -4,11 +4,17 @@
 #include "types.h"
 #include "common.h"
 
+bool set_sim_rate(int hz);
+void save_previous_transforms(Player* player, Enemy* enemies, Bullet* bullets);
+Player interpolate_player(const Player* player, float alpha);
 void update_camera(Camera* camera, Player* player, World* world, SDL_Renderer* renderer);
-void update_player_angle(Camera* camera, Player* player);
+void center_camera(Camera* camera, Player* player, World* world);
+void read_player_input(PlayerInput* input, const Camera* camera, const Player* player);
 void spawn_bullet(Bullet* bullets, Entity* entity, int owner);
 void update_bullets(Bullet* bullets, World* world, float dt);
-void fixed_update_player(Player* player, World* world, Bullet* bullets, Camera* camera, Console* console);
+void move_with_wall_collision(float* x, float* y, float w, float h, float vel_x, float vel_y, World* world);
+void hit_enemy_with_bullets(Enemy* enemy, Bullet* bullets);
+void apply_player_input(Player* player, World* world, Bullet* bullets, const PlayerInput* input);
 void fixed_update_enemies(Player* player, World* world, Bullet* bullets, Enemy* enemies, Camera* camera, GameState* game_state);
 
 #endif
@@ -0,0 +1,14 @@
+#ifndef INFLUENCE_H
+#define INFLUENCE_H
+
+#include "types.h"
+#include "common.h"
+
+void init_influence_map(World* world);
+void update_influence_map(World* world, Player* player, Enemy* enemies);
+void report_player_seen(World* world, int tile_x, int tile_y);
+bool get_last_seen_position(World* world, int* tile_x, int* tile_y);
+float get_influence(World* world, InfluenceLayer layer, int tile_x, int tile_y);
+void free_influence_map(World* world);
+
+#endif
@@ -0,0 +1,11 @@
+#ifndef LEVEL_H
+#define LEVEL_H
+
+#include "types.h"
+#include "common.h"
+
+void load_level_map(World* world);
+bool init_flags(World* world, int enemies_per_flag, SDL_Texture* flag_texture);
+int spawn_flag_enemies(World* world, Enemy* enemies, Camera* camera);
+
+#endif
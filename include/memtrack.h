@@ -0,0 +1,21 @@
+#ifndef MEMTRACK_H
+#define MEMTRACK_H
+
+#include "types.h"
+#include "common.h"
+
+void* my_malloc(size_t size);
+void* my_calloc(size_t count, size_t size);
+void* my_realloc(void* ptr, size_t size);
+void my_free(void* ptr);
+SDL_Texture* create_tracked_texture(SDL_Renderer* renderer, Uint32 format, int access, int w, int h, const char* name);
+SDL_Texture* create_tracked_texture_from_surface(SDL_Renderer* renderer, SDL_Surface* surface, const char* name);
+void destroy_tracked_texture(SDL_Texture* texture);
+void mark_stack_base(void);
+void note_stack_depth(StackSite site);
+void end_memory_frame(void);
+void get_memory_stats(MemoryStats* stats);
+const char* get_stack_site_name(StackSite site);
+void print_memory_report(void);
+
+#endif
@@ -0,0 +1,12 @@
+#ifndef PACING_H
+#define PACING_H
+
+#include "types.h"
+#include "common.h"
+
+void init_frame_pacer(FramePacer* pacer, float fps, bool vsync);
+void pace_frame(FramePacer* pacer);
+bool set_max_sim_steps(int steps);
+int limit_sim_steps(double* accumulator, double step);
+
+#endif
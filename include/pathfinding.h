@@ -5,7 +5,7 @@
 #include "common.h"
 
 int get_heuristic(int x1, int y1, int x2, int y2);
-void find_path(Entity* entity, World* world, int target_x, int target_y);
+int find_path(Entity* entity, World* world, int target_x, int target_y);
 void move_along_path(Enemy* enemy, World* world, int enemy_index, int last_target_x, int last_target_y);
 void spawn_enemy(Enemy* enemy, World* world, Camera* camera, int flag_id);
 void find_cover_point(Enemy* enemy, World* world, int player_x, int player_y, int* cover_x, int* cover_y);
@@ -0,0 +1,12 @@
+#ifndef PIPELINE_H
+#define PIPELINE_H
+
+#include "types.h"
+#include "common.h"
+
+bool start_sim_pipeline(SimPipeline* pipeline, Player* player, World* world, Enemy* enemies, Bullet* bullets, GameState* game_state, SnapshotBuffer* snapshots);
+void stop_sim_pipeline(SimPipeline* pipeline);
+void lock_simulation(SimPipeline* pipeline);
+void unlock_simulation(SimPipeline* pipeline);
+
+#endif
@@ -0,0 +1,34 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include "types.h"
+#include "common.h"
+
+// Timing zones. PROFILE_BEGIN opens a zone that PROFILE_END in the same scope closes; without
+// ENABLE_PROFILER both expand to nothing, so zones cost nothing in builds that leave it out.
+// Zones entered once per enemy close with PROFILE_SUM_END instead, adding to a ProfileSum that
+// PROFILE_RECORD_SUM records once per zone, so they don't contend for the profiler per enemy.
+#ifdef ENABLE_PROFILER
+#define PROFILE_BEGIN(zone) Uint64 profile_start_##zone = SDL_GetPerformanceCounter()
+#define PROFILE_END(zone) profile_record(zone, profile_start_##zone, SDL_GetPerformanceCounter())
+#define PROFILE_SUM_END(sum, zone) ((sum)->ticks[zone] += SDL_GetPerformanceCounter() - profile_start_##zone)
+#define PROFILE_RECORD_SUM(sum) profile_record_sum(sum)
+#else
+#define PROFILE_BEGIN(zone) do {} while (0)
+#define PROFILE_END(zone) do {} while (0)
+#define PROFILE_SUM_END(sum, zone) do {} while (0)
+#define PROFILE_RECORD_SUM(sum) do {} while (0)
+#endif
+
+void profile_record(ProfileZone zone, Uint64 start, Uint64 end);
+void profile_record_sum(const ProfileSum* sum);
+void profile_dropped_time(int steps, double seconds);
+void profile_end_frame(void);
+const ProfileFrame* get_profile_frame(int age);
+void get_profile_stats(ProfileZone zone, ProfileStats* stats);
+const char* get_profile_zone_name(ProfileZone zone);
+int get_profile_zone_depth(ProfileZone zone);
+bool toggle_profiler_overlay(void);
+void render_profiler(SDL_Renderer* renderer, GlyphAtlas* glyphs);
+
+#endif
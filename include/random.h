@@ -0,0 +1,14 @@
+#ifndef RANDOM_H
+#define RANDOM_H
+
+#include "types.h"
+#include "common.h"
+
+Uint64 random_stream_selector(RandomSubsystem subsystem, int index);
+void init_random_stream(RandomStream* rng, Uint64 seed, Uint64 selector);
+Uint32 next_random(RandomStream* rng);
+int random_below(RandomStream* rng, int bound);
+void seed_enemy_random(Enemy* enemies, Uint64 seed);
+bool parse_seed(const char* text, Uint64* seed);
+
+#endif
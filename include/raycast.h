@@ -0,0 +1,15 @@
+#ifndef RAYCAST_H
+#define RAYCAST_H
+
+#include "types.h"
+#include "common.h"
+
+// Bit for a wall type in a ray's block mask, e.g. RAY_BLOCK(WALL_OPAQUE) | RAY_BLOCK(WALL_BULLETPROOF)
+#define RAY_BLOCK(type) (1u << (type))
+
+void cast_rays(float origin_x, float origin_y, const float* dir_x, const float* dir_y, int count, float max_dist,
+               unsigned block_mask, World* world, float* dist_out, int* tile_out);
+float cast_ray(float origin_x, float origin_y, float dir_x, float dir_y, float max_dist,
+               unsigned block_mask, World* world, int* tile_out);
+
+#endif
@@ -0,0 +1,12 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include "types.h"
+#include "common.h"
+
+void build_render_snapshot(RenderSnapshot* snap, const RenderSnapshot* previous, Player* player, World* world, Enemy* enemies, Bullet* bullets);
+void init_snapshot_buffer(SnapshotBuffer* buffer);
+void publish_render_snapshot(SnapshotBuffer* buffer, Player* player, World* world, Enemy* enemies, Bullet* bullets);
+const RenderSnapshot* acquire_render_snapshot(SnapshotBuffer* buffer);
+
+#endif
@@ -0,0 +1,13 @@
+#ifndef SPRITES_H
+#define SPRITES_H
+
+#include "types.h"
+#include "common.h"
+
+bool build_sprite_atlas(SpriteAtlas* atlas, SDL_Renderer* renderer, const char* const paths[SPRITE_COUNT]);
+void free_sprite_atlas(SpriteAtlas* atlas);
+void begin_sprite_batch(SpriteBatch* batch, SDL_Renderer* renderer, SpriteAtlas* atlas);
+void add_sprite(SpriteBatch* batch, SpriteId id, SDL_Texture* texture, float x, float y, float w, float h, float angle, Uint8 alpha);
+void flush_sprite_batch(SpriteBatch* batch);
+
+#endif
@@ -0,0 +1,14 @@
+#ifndef TEXT_H
+#define TEXT_H
+
+#include "types.h"
+#include "common.h"
+
+bool build_glyph_atlas(GlyphAtlas* atlas, SDL_Renderer* renderer, TTF_Font* font);
+void free_glyph_atlas(GlyphAtlas* atlas);
+int measure_text(const GlyphAtlas* atlas, const char* text);
+void begin_text_batch(TextBatch* batch, SDL_Renderer* renderer, GlyphAtlas* atlas);
+void add_text(TextBatch* batch, const char* text, int x, int y, SDL_Color color);
+void flush_text_batch(TextBatch* batch);
+
+#endif
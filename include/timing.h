@@ -0,0 +1,13 @@
+#ifndef TIMING_H
+#define TIMING_H
+
+#include "types.h"
+#include "common.h"
+
+void record_timing(TimingMetric metric, Uint64 start, Uint64 end);
+void get_timing_summary(TimingMetric metric, TimingSummary* summary);
+const char* get_timing_name(TimingMetric metric);
+void print_timing_report(void);
+bool write_timing_report(const char* path);
+
+#endif
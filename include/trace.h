@@ -0,0 +1,25 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include "types.h"
+#include "common.h"
+
+// Trace events outside the profiler's zones. TRACE_BEGIN marks the start of a scope and
+// TRACE_END(id, name, arg_count, ["arg name", value]...) records it. Like the profiling zones,
+// they vanish without ENABLE_PROFILER; the dead call keeps their arguments referenced.
+#ifdef ENABLE_PROFILER
+#define TRACE_BEGIN(id) Uint64 trace_start_##id = SDL_GetPerformanceCounter()
+#define TRACE_END(id, name, ...) trace_event(name, trace_start_##id, SDL_GetPerformanceCounter(), __VA_ARGS__)
+#else
+#define TRACE_BEGIN(id) do {} while (0)
+#define TRACE_END(id, name, ...) do { if (0) trace_event(name, 0, 0, __VA_ARGS__); } while (0)
+#endif
+
+bool start_trace(const char* path);
+bool stop_trace(const char* path);
+bool is_tracing(void);
+int get_trace_event_count(void);
+void name_trace_thread(const char* name);
+void trace_event(const char* name, Uint64 start, Uint64 end, int arg_count, ...);
+
+#endif
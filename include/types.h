@@ -19,8 +19,19 @@ typedef struct{
     float vel_x, vel_y;// Velocity in pixels per second
     float angle;       // Rotation angle in degrees
     SDL_Texture* texture; // Texture for rendering the player
+    float prev_x, prev_y; // Position at the start of the last fixed update, for render interpolation
+    float prev_angle;  // Angle at the start of the last fixed update
 } Player;
 
+// Represents one fixed update's worth of player input, from the keyboard and mouse or from a script
+typedef struct{
+    float move_x, move_y; // Movement direction on each axis (-1, 0 or 1)
+    bool aim;          // Whether to turn the player to angle this update
+    float angle;       // Angle to face in degrees, used when aim is set
+    bool turn_limited; // Whether to turn towards angle at most MAX_PLAYER_ROTATION per update, as the mouse does
+    bool fire;         // Whether to shoot a bullet this update
+} PlayerInput;
+
 // Represents a bullet with position, velocity, lifetime, activity status, and owner
 typedef struct{
     float x, y;        // Position coordinates in pixels
@@ -28,8 +39,24 @@ typedef struct{
     float lifetime;    // Time remaining before bullet expires (in seconds)
     bool active;       // Whether the bullet is active
     int owner;         // Owner of the bullet (0 for enemy, 1 for player)
+    float prev_x, prev_y; // Position at the start of the last fixed update, for render interpolation
 } Bullet;
 
+// Represents one PCG32 random number stream. Streams seeded with the same seed but a
+// different stream selector give independent sequences.
+typedef struct{
+    Uint64 state;      // Current generator state
+    Uint64 inc;        // Odd increment picked by the stream selector
+} RandomStream;
+
+// Enumerates the subsystems that draw random numbers, each from its own streams
+typedef enum{
+    RANDOM_SPAWN = 0,  // Spawn positions and facing
+    RANDOM_WANDER = 1, // Idle enemies choosing where to wander
+    RANDOM_INPUT = 2,  // Scripted players, such as the headless bench's
+    RANDOM_STREAM_COUNT = 3
+} RandomSubsystem;
+
 // Enumerates the possible states of an enemy
 typedef enum{
     FREE = 0,          // Enemy is idle and not engaged
@@ -58,6 +85,10 @@ typedef struct{
     float decision_timer;// Timer for AI decision-making
     bool in_cover;     // Whether the enemy is in cover
     int flag_id;       // ID of the associated flag for spawning
+    float prev_x, prev_y; // Position at the start of the last fixed update, for render interpolation
+    float prev_angle;  // Angle at the start of the last fixed update
+    RandomStream spawn_random; // Stream for this enemy's spawn points, see seed_enemy_random
+    RandomStream wander_random;// Stream for this enemy's wandering
 } Enemy;
 
 // Enumerates the types of walls in the game
@@ -77,6 +108,113 @@ typedef struct{
     SDL_Texture* texture; // Texture for rendering the wall
 } Wall;
 
+// Represents a cover position next to a small wall
+typedef struct{
+    int x, y;          // Tile coordinates of the cover position
+    int wall_x, wall_y;// Tile coordinates of the small wall providing cover
+    int normal_x, normal_y; // Wall normal (direction from the wall to the cover position)
+} CoverPoint;
+
+// Represents a cover point that is valid against the cached player tile
+typedef struct{
+    int point;         // Index into World.cover_points
+    float player_score;// Score contribution from the distance to the player
+    float weight;      // Score multiplier (0.5 when the wall is between cover and player)
+} CoverCandidate;
+
+// Caches cover point evaluation for one player tile, shared by all enemies
+typedef struct{
+    CoverCandidate* candidates; // Valid candidates sorted by spatial bin
+    int count;         // Number of valid candidates
+    int bin_start[COVER_BINS * COVER_BINS + 1]; // Index of the first candidate in each bin
+    int player_x, player_y; // Player tile the candidates were evaluated for
+    int version;       // Map version the candidates were evaluated for (-1 if never evaluated)
+} CoverCache;
+
+// Identifies an image in the sprite atlas
+typedef enum{
+    SPRITE_PLAYER = 0,
+    SPRITE_ENEMY = 1,
+    SPRITE_GRASS = 2,
+    SPRITE_WALL_SMALL = 3,
+    SPRITE_WALL_BULLETPROOF = 4,
+    SPRITE_WALL_OPAQUE = 5,
+    SPRITE_FLAG = 6,
+    SPRITE_COUNT = 7
+} SpriteId;
+
+// Represents every sprite image packed into one texture
+typedef struct{
+    SDL_Texture* texture; // Atlas texture (NULL if it could not be built)
+    int w, h;          // Atlas size in pixels
+    SDL_Rect regions[SPRITE_COUNT]; // Location of each sprite in the atlas
+} SpriteAtlas;
+
+// Represents one queued sprite of a batch
+typedef struct{
+    SpriteId id;       // Sprite to draw
+    SDL_Texture* texture; // Standalone texture, used when the atlas or geometry is unavailable
+    SDL_FRect dst;     // Screen rect before rotation
+    float angle;       // Rotation around the rect centre in degrees
+    Uint8 alpha;       // Opacity
+} SpriteInstance;
+
+// Represents sprites queued for a single draw call
+typedef struct{
+    SDL_Renderer* renderer;
+    SpriteAtlas* atlas;
+    SpriteInstance sprites[SPRITE_BATCH_MAX];
+    int count;         // Number of queued sprites
+} SpriteBatch;
+
+// Represents every printable glyph of a font rasterised once into one texture
+typedef struct{
+    SDL_Texture* texture; // Atlas texture of white glyphs, tinted per vertex (NULL if it could not be built)
+    int w, h;          // Atlas size in pixels
+    int line_height;   // Height of a line of text in pixels
+    SDL_Rect regions[GLYPH_COUNT]; // Location of each glyph in the atlas (zero size for blank glyphs)
+    int advance[GLYPH_COUNT]; // Horizontal pen advance of each glyph in pixels
+} GlyphAtlas;
+
+// Represents one queued glyph of a text batch
+typedef struct{
+    int glyph;         // Glyph index into the atlas
+    float x, y;        // Screen position of the glyph's top left corner
+    SDL_Color color;   // Tint of the glyph
+} GlyphInstance;
+
+// Represents text queued for a single draw call
+typedef struct{
+    SDL_Renderer* renderer;
+    GlyphAtlas* atlas;
+    GlyphInstance glyphs[TEXT_BATCH_MAX];
+    int count;         // Number of queued glyphs
+} TextBatch;
+
+// Represents how the FOV mask is drawn
+typedef enum{
+    FOV_BACKEND_AUTO = 0,     // Software rasteriser on software renderers, GPU geometry otherwise
+    FOV_BACKEND_GEOMETRY = 1, // Render-target texture drawn with SDL geometry
+    FOV_BACKEND_SOFTWARE = 2  // Streaming texture filled by the CPU span rasteriser
+} FovBackend;
+
+// Enumerates the layers of the tactical influence map
+typedef enum{
+    INFLUENCE_THREAT = 0,   // Exposure to the player's sight cone
+    INFLUENCE_DENSITY = 1,  // Concentration of active enemies
+    INFLUENCE_LAST_SEEN = 2,// Last known player position, fading over time
+    INFLUENCE_LAYER_COUNT = 3
+} InfluenceLayer;
+
+// Represents the tactical influence map shared by all enemies
+typedef struct{
+    float layers[INFLUENCE_LAYER_COUNT][MAP_SIZE][MAP_SIZE]; // Influence values per tile
+    uint8_t enemy_count[MAP_SIZE][MAP_SIZE]; // Active enemies per tile, stamped every update
+    int next_row;      // First row refreshed by the next update
+    int last_seen_x, last_seen_y; // Tile where the player was last seen (-1 if never)
+    bool player_seen;  // Whether the player was seen since the last update
+} InfluenceMap;
+
 // Represents a flag (spawn point) with position, size, texture, and spawning properties
 typedef struct{
     float x, y;        // Position coordinates in pixels
@@ -92,13 +230,27 @@ typedef struct{
 typedef struct{
     int w, h;          // World width and height in pixels
     SDL_Texture* background; // Texture for the world background
-    SDL_Texture* minimap_texture; // Texture for the minimap (if pre-rendered)
+    SpriteAtlas atlas; // Sprite images packed into one texture
+    GlyphAtlas glyphs; // UI font glyphs packed into one texture
+    SDL_Texture* minimap_texture; // Minimap background and walls, baked on map changes (NULL until first drawn)
+    int minimap_version; // Map version the minimap texture was baked from
     uint8_t map[MAP_SIZE][MAP_SIZE]; // 2D array representing the map grid
     Wall* walls;       // Array of walls
     int wall_count;    // Number of walls
+    int wall_at[MAP_SIZE][MAP_SIZE]; // Index into walls of each tile's wall (-1 if the tile never had one)
+    SDL_Texture* wall_textures[WALL_OPAQUE + 1]; // Texture for each wall type, used for walls added later
+    SDL_Texture* chunks[MAP_CHUNKS_Y][MAP_CHUNKS_X]; // Background and walls baked per chunk (NULL if unavailable)
+    bool chunk_dirty[MAP_CHUNKS_Y][MAP_CHUNKS_X]; // Whether a chunk's tiles changed since it was baked
     Flag* flags;       // Ascending
     int flag_count;   // Number of flags
     float fps;			// Game fps
+    int map_version;   // Incremented whenever the map grid changes
+    CoverPoint* cover_points; // Cover points sorted by spatial bin
+    int cover_count;   // Number of cover points
+    int cover_bin_start[COVER_BINS * COVER_BINS + 1]; // Index of the first cover point in each bin
+    int cover_version; // Map version the cover index was built from
+    CoverCache cover_cache; // Cover evaluation shared by all enemies
+    InfluenceMap* influence; // Tactical influence map (NULL if not allocated)
 } World;
 
 // Represents the camera for rendering the game view
@@ -120,11 +272,8 @@ typedef struct{
 typedef struct {
     char text[MAX_CONSOLE_LINES][MAX_COMMAND_LENGTH]; // Array of console message lines
     float timestamps[MAX_CONSOLE_LINES]; // Timestamps for message expiration
-    SDL_Texture* console_textures[MAX_CONSOLE_LINES]; // Textures for rendering console messages
     char input[MAX_COMMAND_LENGTH]; // Current input string
-    SDL_Texture* input_texture; // Texture for rendering input text
     char suggestion[MAX_COMMAND_LENGTH]; // Autocomplete suggestion text
-    SDL_Texture* suggestion_texture; // Texture for rendering suggestion text
     char history[MAX_HISTORY][MAX_COMMAND_LENGTH]; // Command history
     int history_count; // Number of commands in history
     int history_index; // Current position in history (-1 for current input)
@@ -142,6 +291,189 @@ typedef struct{
     bool spawn_enabled;// Whether enemy spawning is enabled
 } GameState;
 
+// Enumerates the profiled parts of a frame. Zones nested inside another zone are
+// listed after it; the nesting itself is in profiler.c.
+typedef enum{
+    PROFILE_PLAYER = 0,         // Player fixed update
+    PROFILE_BULLETS = 1,        // Bullet movement, inside the player update
+    PROFILE_ENEMIES = 2,        // Enemy fixed update
+    PROFILE_SPAWN = 3,          // Flag spawning and respawns
+    PROFILE_INFLUENCE = 4,      // Influence map update
+    PROFILE_DECISIONS = 5,      // Enemy perception and state changes
+    PROFILE_PATHFINDING = 6,    // find_path calls made by the decisions
+    PROFILE_COVER = 7,          // find_cover_point calls made by the decisions
+    PROFILE_MOVEMENT = 8,       // Path following, shooting and wall collision
+    PROFILE_HITS = 9,           // Player bullets hitting enemies
+    PROFILE_SNAPSHOT = 10,      // Building and publishing the render snapshot
+    PROFILE_RENDER_MAP = 11,    // Clearing and drawing the map chunks
+    PROFILE_RENDER_SPRITES = 12,// Flags, player and enemies
+    PROFILE_RENDER_BULLETS = 13,// Bullets
+    PROFILE_RENDER_FOV = 14,    // FOV mask
+    PROFILE_RENDER_HUD = 15,    // FPS counter and status line
+    PROFILE_RENDER_CONSOLE = 16,// Console
+    PROFILE_RENDER_MINIMAP = 17,// Minimap
+    PROFILE_RENDER_MENU = 18,   // Menu
+    PROFILE_PRESENT = 19,       // SDL_RenderPresent, including any wait for the GPU
+    PROFILE_ZONE_COUNT = 20
+} ProfileZone;
+
+// Holds time summed over a tick for zones entered once per enemy, recorded once per zone at the end
+typedef struct{
+    Uint64 ticks[PROFILE_ZONE_COUNT]; // Performance counter ticks spent in each zone
+} ProfileSum;
+
+// Holds how long each zone and the whole frame took in one frame
+typedef struct{
+    float zone_ms[PROFILE_ZONE_COUNT]; // Milliseconds spent in each zone
+    float frame_ms;    // Milliseconds since the previous frame ended
+    float dropped_ms;  // Simulation time dropped for running behind, see limit_sim_steps
+} ProfileFrame;
+
+// Paces the main loop to a frame rate, or leaves that to vsync
+typedef struct{
+    Uint64 period;     // Performance counter ticks per frame
+    Uint64 deadline;   // Counter value the current frame should end at
+    bool vsync;        // Whether presenting waits for vsync, making pacing unnecessary
+    Uint64 last_present; // Counter value at the end of the last vsync frame, 0 before the first
+    int fast_frames;   // Vsync frames in a row that ended too soon after the last for vsync to be working
+} FramePacer;
+
+// Represents one complete (begin and end) event recorded by the tracer
+typedef struct{
+    const char* name;  // Event name; a string literal, not copied
+    Uint64 start, end; // Performance counter values at the start and end
+    SDL_threadID thread; // Thread the event ran on
+    int arg_count;     // Number of arguments used
+    const char* arg_names[TRACE_MAX_ARGS]; // Argument names; string literals
+    int args[TRACE_MAX_ARGS]; // Argument values
+} TraceEvent;
+
+// Summarises a zone over the frames in the profiler's history
+typedef struct{
+    float min_ms;      // Shortest frame
+    float avg_ms;      // Mean
+    float p99_ms;      // 99th percentile
+} ProfileStats;
+
+// Enumerates the durations collected in histograms for the whole session
+typedef enum{
+    TIMING_FRAME = 0,           // Whole frame, including the wait for the next one
+    TIMING_TICK = 1,            // One fixed update of player and enemies
+    TIMING_RENDER = 2,          // Drawing and presenting a frame
+    TIMING_METRIC_COUNT = 3
+} TimingMetric;
+
+// Counts durations in log-linear buckets of microseconds: exact below 64 us, then 32 buckets
+// per power of two, so any value is kept to within about 3% in a fixed amount of memory
+typedef struct{
+    Uint32 buckets[TIMING_BUCKETS]; // Number of durations in each bucket
+    Uint64 count;      // Number of durations recorded
+    double sum_us;     // Their total, for the mean
+    Uint64 max_us;     // Longest duration, exactly
+} TimingHistogram;
+
+// Summarises a histogram, all in milliseconds
+typedef struct{
+    Uint64 count;      // Number of durations recorded
+    float mean_ms;     // Mean
+    float p50_ms, p90_ms, p99_ms, p999_ms; // Percentiles, to within the bucket precision
+    float max_ms;      // Longest
+} TimingSummary;
+
+// Enumerates the functions whose deepest stack use is recorded, see note_stack_depth
+typedef enum{
+    STACK_TICK = 0,             // Enemy fixed update
+    STACK_FIND_PATH = 1,        // A* search, with its open and closed lists on the stack
+    STACK_FIND_COVER = 2,       // Cover search
+    STACK_RENDER = 3,           // Drawing a frame
+    STACK_SITE_COUNT = 4
+} StackSite;
+
+// Summarises the memory tracked by memtrack.c: heap allocations made through my_malloc and its
+// siblings, textures made through create_tracked_texture and friends, and stack depths
+typedef struct{
+    Uint64 allocs, frees; // Heap allocations and frees so far
+    Uint64 heap_bytes; // Bytes allocated and not yet freed
+    Uint64 heap_peak_bytes; // Most bytes allocated at once
+    int frame_allocs, frame_frees; // Heap allocations and frees in the last frame
+    int textures;      // Tracked textures alive
+    Uint64 texture_bytes; // Their estimated size, at their pixel format's bytes per pixel
+    Uint64 texture_peak_bytes; // Largest estimated texture memory at once
+    Uint64 textures_created, textures_destroyed; // Tracked textures made and destroyed so far
+    int frame_textures_created, frame_textures_destroyed; // The same in the last frame
+    int untracked_textures; // Textures made while the registry was full, so not counted
+    int stack_peak[STACK_SITE_COUNT]; // Deepest stack seen at each site, in bytes below the thread's base
+} MemoryStats;
+
+// Represents the visibility polygons the FOV mask is drawn from, as rays around the player centre
+typedef struct{
+    float sector_cos[FOV_MAX_RAYS], sector_sin[FOV_MAX_RAYS], sector_dist[FOV_MAX_RAYS]; // 90-degree view sector
+    float circle_cos[FOV_MAX_RAYS], circle_sin[FOV_MAX_RAYS], circle_dist[FOV_MAX_RAYS]; // 360-degree close circle
+    int sector_rays;   // Number of rays in the sector
+    int circle_rays;   // Number of rays in the circle
+    Uint32 hash;       // Hash of the player centre, angle and map version the polygons were built for
+} FovPolygons;
+
+// Represents an enemy as the renderer sees it after one simulation tick
+typedef struct{
+    float x, y;        // Position at the end of the tick
+    float prev_x, prev_y; // Position at the start of the tick
+    float w, h;        // Width and height in pixels
+    float angle;       // Angle at the end of the tick
+    float prev_angle;  // Angle at the start of the tick
+    Uint8 alpha;       // Visibility to the player (0 outside the FOV)
+    bool in_cover;     // Whether the enemy is in cover
+    SDL_Texture* texture; // Texture for rendering the enemy
+} EnemyView;
+
+// Represents a bullet as the renderer sees it after one simulation tick
+typedef struct{
+    float x, y;        // Position at the end of the tick
+    float prev_x, prev_y; // Position at the start of the tick
+} BulletView;
+
+// Represents everything the renderer needs from one simulation tick. It is built by the simulation
+// and never changed once published, so it can be drawn while the next tick runs.
+typedef struct{
+    Uint32 sequence;   // Number of snapshots built before this one
+    Uint64 time;       // Performance counter when the snapshot was built
+    float dt;          // Fixed time step of the tick in seconds
+    Player player;     // Player, including its previous transform
+    EnemyView enemies[MAX_ENEMIES]; // Active enemies
+    int enemy_count;
+    BulletView bullets[MAX_BULLETS]; // Active bullets
+    int bullet_count;
+    FovPolygons fov;   // Visibility polygons at the end of the tick
+    char hud_text[SNAPSHOT_HUD_LENGTH]; // Simulation status line
+} RenderSnapshot;
+
+// Represents three render snapshots handed from the simulation to the renderer without locks.
+// The simulation fills the back slot, the renderer draws the front slot, and the ready slot holds
+// the newest complete snapshot; publishing and acquiring swap a slot with it atomically.
+typedef struct{
+    RenderSnapshot slots[3];
+    int back;          // Slot being written (simulation side only)
+    int latest;        // Slot published last, -1 before the first (simulation side only)
+    int front;         // Slot being drawn (render side only)
+    SDL_atomic_t ready;// Newest published slot, plus SNAPSHOT_FRESH until the renderer takes it
+} SnapshotBuffer;
+
+// Represents the simulation running on its own thread, one tick ahead of the renderer
+typedef struct{
+    SDL_Thread* thread; // Simulation thread (NULL when the simulation runs on the main thread)
+    SDL_mutex* lock;   // Held by the simulation for each tick and by the main thread while it changes simulation state
+    SDL_atomic_t running; // Cleared to stop the thread
+    SDL_atomic_t paused; // Whether the simulation is paused (menu open)
+    SDL_atomic_t view_w, view_h; // Renderer output size, for the simulation's camera
+    Player* player;
+    World* world;
+    Enemy* enemies;
+    Bullet* bullets;
+    GameState* game_state;
+    SnapshotBuffer* snapshots; // Where ticks are published
+    PlayerInput input; // Latest input, read on the main thread and handed over under lock; fire holds until a tick uses it
+} SimPipeline;
+
 typedef enum {
     MAIN_MENU = 0,
     OPTIONS_MENU = 1
@@ -150,7 +482,6 @@ typedef enum {
 typedef struct {
     char text[MENU_OPTION_TEXT_LENGTH];
     SDL_Rect rect;
-    SDL_Texture* text_texture;
     bool is_hovered;
 } MenuOption;
 
@@ -161,7 +492,7 @@ typedef struct {
     MenuOption options_menu_options[MENU_OPTION_COUNT];
     int selected_option; // -1 for none
     GameState* game_state; // Pointer to game state for toggling
-    TTF_Font* font; // Font for rendering text
+    GlyphAtlas* glyphs; // Glyph atlas for rendering text
 } Menu;
 
 #endif
@@ -11,15 +11,18 @@ float my_sqrt(float x);
 float my_atan2f(float y,float x);
 float my_cosf(float x);
 float my_sinf(float x);
+float lerp_angle(float from, float to, float t);
 SDL_Texture* load_texture(const char* path, SDL_Renderer* renderer);
 SDL_Texture* create_background_texture(SDL_Renderer* renderer, SDL_Texture* tile, int world_w, int world_h);
 void init_walls(World* world, SDL_Renderer* renderer, SDL_Texture* wall_texture_S, SDL_Texture* wall_texture_B, SDL_Texture* wall_texture_O);
+bool set_map_tile(World* world, int x, int y, WallType type);
 bool check_collision(float x1, float y1, float w1, float h1, float x2, float y2, float w2, float h2);
 bool is_valid_node(int x, int y, World* world);
 bool has_line_of_sight(float start_x, float start_y, float end_x, float end_y, World* world, bool block_by_bulletproof, bool block_by_opaque);
 void SDL_RenderFillPolygon(SDL_Renderer* renderer, const SDL_Point* points, int count);
 float ray_aabb_intersect(float px, float py, float dx, float dy, float minx, float miny, float maxx, float maxy);
 float get_visibility_distance(float x1, float y1, float dx, float dy, World* world);
+Uint32 hash_bytes(Uint32 hash, const void* data, size_t size);
 
 size_t my_strlen(const char *str);
 char *my_strcpy(char *dest, const char *src);
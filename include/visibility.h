@@ -0,0 +1,11 @@
+#ifndef VISIBILITY_H
+#define VISIBILITY_H
+
+#include "types.h"
+#include "common.h"
+
+int build_visibility_polygon(float origin_x, float origin_y, float facing_rad, float half_angle_rad, float range,
+                             World* world, float* cos_out, float* sin_out, float* dist_out, int max_rays);
+void build_fov_polygons(FovPolygons* fov, const FovPolygons* previous, Player* player, World* world);
+
+#endif
@@ -0,0 +1,109 @@
+#include "chunks.h"
+#include "memtrack.h"
+
+// Returns the world-space rect covered by a chunk (edge chunks are clipped to the world)
+static SDL_Rect get_chunk_rect(int cx, int cy) {
+    SDL_Rect rect = {cx * MAP_CHUNK_SIZE, cy * MAP_CHUNK_SIZE, MAP_CHUNK_SIZE, MAP_CHUNK_SIZE};
+    if (rect.x + rect.w > WORLD_W) rect.w = WORLD_W - rect.x;
+    if (rect.y + rect.h > WORLD_H) rect.h = WORLD_H - rect.y;
+    return rect;
+}
+
+// Draws a chunk's grass and walls with the chunk's top-left corner at (dst_x, dst_y)
+static void draw_chunk_contents(SDL_Renderer* renderer, World* world, int cx, int cy, int dst_x, int dst_y) {
+    SDL_Rect chunk = get_chunk_rect(cx, cy);
+    SDL_Rect dst = {dst_x, dst_y, chunk.w, chunk.h};
+    SDL_RenderCopy(renderer, world->background, &chunk, &dst);
+
+    int min_tx = chunk.x / TILE_SIZE, max_tx = (chunk.x + chunk.w) / TILE_SIZE;
+    int min_ty = chunk.y / TILE_SIZE, max_ty = (chunk.y + chunk.h) / TILE_SIZE;
+    if (max_tx > MAP_SIZE) max_tx = MAP_SIZE;
+    if (max_ty > MAP_SIZE) max_ty = MAP_SIZE;
+    for (int ty = min_ty; ty < max_ty; ty++) {
+        for (int tx = min_tx; tx < max_tx; tx++) {
+            int i = world->wall_at[ty][tx];
+            if (i < 0 || world->walls[i].type == WALL_NONE || !world->walls[i].texture) continue;
+            SDL_Rect wall_rect = {
+                (int)world->walls[i].x - chunk.x + dst_x,
+                (int)world->walls[i].y - chunk.y + dst_y,
+                (int)world->walls[i].w,
+                (int)world->walls[i].h
+            };
+            SDL_SetTextureAlphaMod(world->walls[i].texture, 255);
+            SDL_RenderCopy(renderer, world->walls[i].texture, NULL, &wall_rect);
+        }
+    }
+}
+
+// Creates the chunk textures the static map is baked into. Chunks that cannot be created stay
+// NULL and are drawn tile by tile instead.
+void init_map_chunks(World* world, SDL_Renderer* renderer) {
+    if (!world || !renderer) {
+        printf("Error: Null world or renderer in init_map_chunks\n");
+        return;
+    }
+    for (int cy = 0; cy < MAP_CHUNKS_Y; cy++) {
+        for (int cx = 0; cx < MAP_CHUNKS_X; cx++) {
+            SDL_Rect rect = get_chunk_rect(cx, cy);
+            world->chunks[cy][cx] = create_tracked_texture(renderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET, rect.w, rect.h, "map chunk");
+            if (!world->chunks[cy][cx]) {
+                printf("Failed to create map chunk texture: %s\n", SDL_GetError());
+                continue;
+            }
+            SDL_SetTextureBlendMode(world->chunks[cy][cx], SDL_BLENDMODE_NONE); // Chunks are fully opaque
+            world->chunk_dirty[cy][cx] = true;
+        }
+    }
+}
+
+// Marks every chunk and the minimap for re-baking (e.g. after the renderer lost its target textures)
+void invalidate_map_chunks(World* world) {
+    world->minimap_version = world->map_version - 1;
+    for (int cy = 0; cy < MAP_CHUNKS_Y; cy++) {
+        for (int cx = 0; cx < MAP_CHUNKS_X; cx++) {
+            world->chunk_dirty[cy][cx] = true;
+        }
+    }
+}
+
+// Draws the background and walls under the camera: one copy per visible chunk. Visible chunks
+// whose tiles changed are re-baked first; chunks off screen wait until they come into view.
+void render_map_chunks(SDL_Renderer* renderer, World* world, Camera* camera) {
+    int min_cx = (int)camera->x / MAP_CHUNK_SIZE, max_cx = (int)(camera->x + camera->w) / MAP_CHUNK_SIZE;
+    int min_cy = (int)camera->y / MAP_CHUNK_SIZE, max_cy = (int)(camera->y + camera->h) / MAP_CHUNK_SIZE;
+    if (camera->x < 0) min_cx = 0;
+    if (camera->y < 0) min_cy = 0;
+    if (max_cx >= MAP_CHUNKS_X) max_cx = MAP_CHUNKS_X - 1;
+    if (max_cy >= MAP_CHUNKS_Y) max_cy = MAP_CHUNKS_Y - 1;
+
+    for (int cy = min_cy; cy <= max_cy; cy++) {
+        for (int cx = min_cx; cx <= max_cx; cx++) {
+            SDL_Rect rect = get_chunk_rect(cx, cy);
+            int dst_x = rect.x - (int)camera->x;
+            int dst_y = rect.y - (int)camera->y;
+            SDL_Texture* chunk = world->chunks[cy][cx];
+            if (!chunk) {
+                draw_chunk_contents(renderer, world, cx, cy, dst_x, dst_y);
+                continue;
+            }
+            if (world->chunk_dirty[cy][cx]) {
+                SDL_Texture* target = SDL_GetRenderTarget(renderer);
+                SDL_SetRenderTarget(renderer, chunk);
+                draw_chunk_contents(renderer, world, cx, cy, 0, 0);
+                SDL_SetRenderTarget(renderer, target);
+                world->chunk_dirty[cy][cx] = false;
+            }
+            SDL_Rect dst = {dst_x, dst_y, rect.w, rect.h};
+            SDL_RenderCopy(renderer, chunk, NULL, &dst);
+        }
+    }
+}
+
+void free_map_chunks(World* world) {
+    for (int cy = 0; cy < MAP_CHUNKS_Y; cy++) {
+        for (int cx = 0; cx < MAP_CHUNKS_X; cx++) {
+            destroy_tracked_texture(world->chunks[cy][cx]);
+            world->chunks[cy][cx] = NULL;
+        }
+    }
+}
@@ -1,32 +1,36 @@
 #include "command.h"
 #include "utils.h"
 #include "common.h"
+#include "text.h"
+#include "game.h"
+#include "profiler.h"
+#include "trace.h"
+#include "timing.h"
+#include "pacing.h"
+#include "memtrack.h"
 
-void init_console(Console* console, SDL_Renderer* renderer, TTF_Font* font) {
+void init_console(Console* console) {
     console->line_count = 0;
     console->current_line = 0;
     console->input_length = 0;
     console->active = false;
     console->input[0] = '\0';
     console->suggestion[0] = '\0';
-    console->suggestion_texture = NULL;
     console->history_count = 0;
     console->history_index = -1;
     console->cursor_pos = 0;
     for (int i = 0; i < MAX_CONSOLE_LINES; i++) {
         console->text[i][0] = '\0';
         console->timestamps[i] = 0.0f;
-        console->console_textures[i] = NULL;
     }
     for (int i = 0; i < MAX_HISTORY; i++) {
         console->history[i][0] = '\0';
     }
-    console->input_texture = NULL;
 }
 
 void compute_suggestion(Console* console) {
     // List of available commands
-    const char* commands[] = {"say", "tp"};
+    const char* commands[] = {"say", "tp", "wall", "simrate", "profiler", "trace", "timings", "maxsteps", "memory"};
     console->suggestion[0] = '\0';
 
     // Find matching command
@@ -137,6 +141,20 @@ void handle_console_input(Console* console, Player* player, World* world, SDL_Ev
     }
 }
 
+// Appends a line to the console, scrolling the oldest line out when full
+static void console_print(Console* console, const char* msg) {
+    if (console->line_count >= MAX_CONSOLE_LINES - 1) {
+        for (int i = 1; i < MAX_CONSOLE_LINES; i++) {
+            my_strcpy(console->text[i - 1], console->text[i]);
+            console->timestamps[i - 1] = console->timestamps[i];
+        }
+        console->line_count = MAX_CONSOLE_LINES - 2;
+    }
+    my_strcpy(console->text[console->line_count], msg);
+    console->timestamps[console->line_count] = 0.0f;
+    console->line_count++;
+}
+
 void execute_command(Console* console, Player* player, World* world, const char* command) {
     char cmd[MAX_COMMAND_LENGTH];
     char arg[MAX_COMMAND_LENGTH];
@@ -209,6 +227,8 @@ void execute_command(Console* console, Player* player, World* world, const char*
 					// Basic collision check (optional, can be expanded)
 					player->x = x;
 					player->y = y;
+					player->prev_x = x; // Jump there instead of interpolating across the map
+					player->prev_y = y;
 					char msg[256];
 					snprintf(msg, sizeof(msg), "Teleported to %.0f, %.0f", x, y);
 					if (console->line_count < MAX_CONSOLE_LINES) {
@@ -238,6 +258,110 @@ void execute_command(Console* console, Player* player, World* world, const char*
                 console->line_count++;
             }
         }
+    } else if (my_strcmp(cmd, "wall") == 0) {
+        int tile_x, tile_y, type;
+        char msg[256];
+        if (sscanf(command, "%*s %d %d %d", &tile_x, &tile_y, &type) != 3 || type < WALL_NONE || type > WALL_OPAQUE) {
+            console_print(console, "Error: Invalid wall command format - use: wall [tile x] [tile y] [0-3]");
+        } else if (!set_map_tile(world, tile_x, tile_y, (WallType)type)) {
+            console_print(console, "Error: Invalid tile");
+        } else {
+            snprintf(msg, sizeof(msg), "Tile %d, %d set to %d", tile_x, tile_y, type);
+            console_print(console, msg);
+        }
+    } else if (my_strcmp(cmd, "simrate") == 0) {
+        int hz;
+        char msg[256];
+        if (sscanf(command, "%*s %d", &hz) != 1) {
+            snprintf(msg, sizeof(msg), "Simulation rate: %d Hz", (int)(1.0f / fixed_dt + 0.5f));
+            console_print(console, msg);
+        } else if (!set_sim_rate(hz)) {
+            snprintf(msg, sizeof(msg), "Error: Simulation rate must be %d-%d Hz", SIM_RATE_MIN, SIM_RATE_MAX);
+            console_print(console, msg);
+        } else {
+            snprintf(msg, sizeof(msg), "Simulation rate set to %d Hz", hz);
+            console_print(console, msg);
+        }
+    } else if (my_strcmp(cmd, "profiler") == 0) {
+        if (!toggle_profiler_overlay()) {
+            console_print(console, "Error: Profiler not built in - rebuild with PROFILE=1");
+        }
+    } else if (my_strcmp(cmd, "trace") == 0) {
+#ifndef ENABLE_PROFILER
+        console_print(console, "Error: Tracing not built in - rebuild with PROFILE=1");
+#else
+        char action[16] = "", path[200] = "";
+        char msg[256];
+        int parsed = sscanf(command, "%*s %15s %199s", action, path);
+        if (parsed < 1) {
+            if (is_tracing()) snprintf(msg, sizeof(msg), "Tracing, %d events buffered", get_trace_event_count());
+            else snprintf(msg, sizeof(msg), "Not tracing - use: trace start [file]");
+            console_print(console, msg);
+        } else if (my_strcmp(action, "start") == 0) {
+            if (!start_trace(parsed > 1 ? path : NULL)) {
+                console_print(console, "Error: Already tracing");
+            } else {
+                console_print(console, "Tracing started");
+            }
+        } else if (my_strcmp(action, "stop") == 0) {
+            int count = get_trace_event_count();
+            if (!is_tracing()) {
+                console_print(console, "Error: Not tracing");
+            } else if (!stop_trace(parsed > 1 ? path : NULL)) {
+                console_print(console, "Error: Could not write trace file, still tracing - use: trace stop <file>");
+            } else {
+                snprintf(msg, sizeof(msg), "Trace written, %d events", count);
+                console_print(console, msg);
+            }
+        } else {
+            console_print(console, "Error: Invalid trace command format - use: trace [start [file]|stop [file]]");
+        }
+#endif
+    } else if (my_strcmp(cmd, "maxsteps") == 0) {
+        int steps;
+        char msg[256];
+        if (sscanf(command, "%*s %d", &steps) != 1) {
+            snprintf(msg, sizeof(msg), "Max fixed updates per frame: %d", max_sim_steps);
+        } else if (!set_max_sim_steps(steps)) {
+            snprintf(msg, sizeof(msg), "Error: Max fixed updates per frame must be %d-%d", MAX_SIM_STEPS_MIN, MAX_SIM_STEPS_MAX);
+        } else {
+            snprintf(msg, sizeof(msg), "Max fixed updates per frame set to %d", steps);
+        }
+        console_print(console, msg);
+    } else if (my_strcmp(cmd, "timings") == 0) {
+        char path[200];
+        char msg[256];
+        for (int i = 0; i < TIMING_METRIC_COUNT; i++) {
+            TimingSummary s;
+            get_timing_summary(i, &s);
+            snprintf(msg, sizeof(msg), "%s ms: p50 %.2f  p90 %.2f  p99 %.2f  p99.9 %.2f  max %.2f", get_timing_name(i),
+                     s.p50_ms, s.p90_ms, s.p99_ms, s.p999_ms, s.max_ms);
+            console_print(console, msg);
+        }
+        print_timing_report();
+        if (sscanf(command, "%*s %199s", path) == 1) {
+            if (write_timing_report(path)) snprintf(msg, sizeof(msg), "Timings written to %s", path);
+            else snprintf(msg, sizeof(msg), "Error: Could not write %s", path);
+            console_print(console, msg);
+        }
+    } else if (my_strcmp(cmd, "memory") == 0) {
+        MemoryStats s;
+        char msg[256];
+        get_memory_stats(&s);
+        snprintf(msg, sizeof(msg), "heap: %llu blocks, %.1f KB live, %.1f KB peak, %d allocs/%d frees last frame",
+                 (unsigned long long)(s.allocs - s.frees), s.heap_bytes / 1024.0, s.heap_peak_bytes / 1024.0,
+                 s.frame_allocs, s.frame_frees);
+        console_print(console, msg);
+        snprintf(msg, sizeof(msg), "textures: %d, ~%.1f KB live, %.1f KB peak, %d created/%d destroyed last frame",
+                 s.textures, s.texture_bytes / 1024.0, s.texture_peak_bytes / 1024.0, s.frame_textures_created,
+                 s.frame_textures_destroyed);
+        console_print(console, msg);
+        int length = snprintf(msg, sizeof(msg), "stack peaks KB:");
+        for (int i = 0; i < STACK_SITE_COUNT && length < (int)sizeof(msg); i++) {
+            length += snprintf(msg + length, sizeof(msg) - length, " %s %.1f", get_stack_site_name(i), s.stack_peak[i] / 1024.0);
+        }
+        console_print(console, msg);
+        print_memory_report();
     } else {
         if (console->line_count < MAX_CONSOLE_LINES) {
             char msg[256];
@@ -249,19 +373,21 @@ void execute_command(Console* console, Player* player, World* world, const char*
     }
 }
 
-void render_console(SDL_Renderer* renderer, Console* console, TTF_Font* font) {
+// Draws the console. Cursor blink and message expiry run on frame_dt, the real time since the last
+// frame in seconds, so they keep time whatever the frame or simulation rate.
+void render_console(SDL_Renderer* renderer, Console* console, GlyphAtlas* glyphs, float frame_dt) {
     static float cursor_timer = 0.0f;
 
     // Update cursor timer
-    cursor_timer += FIXED_DT;
-    if (cursor_timer >= CURSOR_BLINK_INTERVAL) {
+    cursor_timer += frame_dt;
+    while (cursor_timer >= CURSOR_BLINK_INTERVAL) {
         cursor_timer -= CURSOR_BLINK_INTERVAL;
     }
     bool show_cursor = cursor_timer < CURSOR_BLINK_INTERVAL / 2.0f;
 
     // Update message timestamps
     for (int i = 0; i < console->line_count; i++) {
-        console->timestamps[i] += FIXED_DT;
+        console->timestamps[i] += frame_dt;
         if (console->timestamps[i] > MESSAGE_DURATION && !console->active) {
             // Shift messages up when expired
             for (int j = i; j < console->line_count - 1; j++) {
@@ -279,66 +405,31 @@ void render_console(SDL_Renderer* renderer, Console* console, TTF_Font* font) {
         return;
     }
 
-    // Update console textures
+    if (!glyphs || !glyphs->texture) return;
+
+    // Measure the lines from the cached glyph metrics
     SDL_Color white = {255, 255, 255, 255};
     SDL_Color gray = {128, 128, 128, 255}; // Gray for suggestion
-    int max_text_w = 0, text_h = 0;
-    int line_height = 0;
-    TTF_SizeText(font, "A", NULL, &line_height); // Get approximate line height
-
+    int max_text_w = 0;
+    int text_h = glyphs->line_height;
     for (int i = 0; i < console->line_count; i++) {
-        if (console->console_textures[i]) {
-            SDL_DestroyTexture(console->console_textures[i]);
-            console->console_textures[i] = NULL;
-        }
-        if (console->text[i][0] != '\0') {
-            SDL_Surface* surface = TTF_RenderText_Solid(font, console->text[i], white);
-            if (surface) {
-                console->console_textures[i] = SDL_CreateTextureFromSurface(renderer, surface);
-                int text_w;
-                SDL_QueryTexture(console->console_textures[i], NULL, NULL, &text_w, &text_h);
-                max_text_w = SDL_max(max_text_w, text_w);
-                SDL_FreeSurface(surface);
-            }
-        }
+        max_text_w = SDL_max(max_text_w, measure_text(glyphs, console->text[i]));
     }
 
-    // Update input texture with cursor
-    if (console->input_texture) {
-        SDL_DestroyTexture(console->input_texture);
-        console->input_texture = NULL;
-    }
-    if (console->suggestion_texture) {
-        SDL_DestroyTexture(console->suggestion_texture);
-        console->suggestion_texture = NULL;
-    }
+    // Input line with cursor
+    char input_display[MAX_COMMAND_LENGTH + 4];
+    int input_w = 0;
     if (console->active) {
-        char input_display[MAX_COMMAND_LENGTH + 4];
         if (show_cursor) {
             // Insert cursor at the correct position
             snprintf(input_display, sizeof(input_display), ">%.*s|%s", console->cursor_pos, console->input, console->input + console->cursor_pos);
         } else {
             snprintf(input_display, sizeof(input_display), ">%.*s %s", console->cursor_pos, console->input, console->input + console->cursor_pos);
         }
-        SDL_Surface* input_surface = TTF_RenderText_Solid(font, input_display, white);
-        if (input_surface) {
-            console->input_texture = SDL_CreateTextureFromSurface(renderer, input_surface);
-            int text_w;
-            SDL_QueryTexture(console->input_texture, NULL, NULL, &text_w, &text_h);
-            max_text_w = SDL_max(max_text_w, text_w);
-            SDL_FreeSurface(input_surface);
-        }
-
-        // Update suggestion texture
+        input_w = measure_text(glyphs, input_display);
+        max_text_w = SDL_max(max_text_w, input_w);
         if (console->suggestion[0] != '\0') {
-            SDL_Surface* suggestion_surface = TTF_RenderText_Solid(font, console->suggestion, gray);
-            if (suggestion_surface) {
-                console->suggestion_texture = SDL_CreateTextureFromSurface(renderer, suggestion_surface);
-                int text_w;
-                SDL_QueryTexture(console->suggestion_texture, NULL, NULL, &text_w, &text_h);
-                max_text_w = SDL_max(max_text_w, text_w);
-                SDL_FreeSurface(suggestion_surface);
-            }
+            max_text_w = SDL_max(max_text_w, measure_text(glyphs, console->suggestion));
         }
     }
 
@@ -365,61 +456,23 @@ void render_console(SDL_Renderer* renderer, Console* console, TTF_Font* font) {
     SDL_Rect console_rect = {bg_x, bg_y, (bg_width < 500) ? 500 : bg_width, bg_height};
     SDL_RenderFillRect(renderer, &console_rect);
 
+    // Queue all console text into one batch
+    static TextBatch batch;
+    begin_text_batch(&batch, renderer, glyphs);
+
     // Render console history (newest at bottom)
     for (int i = 0; i < console->line_count; i++) {
-        if (console->console_textures[i]) {
-            int text_w, text_h;
-            SDL_QueryTexture(console->console_textures[i], NULL, NULL, &text_w, &text_h);
-            SDL_Rect text_rect = {
-                bg_x + margin,
-                bg_y + margin + (console->line_count - 1 - i) * (text_h + 5), // Reverse order for newest at bottom
-                text_w,
-                text_h
-            };
-            SDL_RenderCopy(renderer, console->console_textures[i], NULL, &text_rect);
-        }
+        add_text(&batch, console->text[i], bg_x + margin,
+                 bg_y + margin + (console->line_count - 1 - i) * (text_h + 5), // Reverse order for newest at bottom
+                 white);
     }
 
-    // Render current input
-    if (console->active && console->input_texture) {
-        int text_w, text_h;
-        SDL_QueryTexture(console->input_texture, NULL, NULL, &text_w, &text_h);
-        SDL_Rect input_rect = {
-            bg_x + margin,
-            cam_h - 10 - text_h, // 10 pixels from bottom
-            text_w,
-            text_h
-        };
-        SDL_RenderCopy(renderer, console->input_texture, NULL, &input_rect);
-
-        // Render suggestion text
-        if (console->suggestion_texture) {
-            int suggestion_w, suggestion_h;
-            SDL_QueryTexture(console->suggestion_texture, NULL, NULL, &suggestion_w, &suggestion_h);
-            SDL_Rect suggestion_rect = {
-                bg_x + margin + text_w, // Position after input text
-                cam_h - 10 - suggestion_h,
-                suggestion_w,
-                suggestion_h
-            };
-            SDL_RenderCopy(renderer, console->suggestion_texture, NULL, &suggestion_rect);
-        }
-    }
-}
-
-void free_console(Console* console) {
-    for (int i = 0; i < MAX_CONSOLE_LINES; i++) {
-        if (console->console_textures[i]) {
-            SDL_DestroyTexture(console->console_textures[i]);
-            console->console_textures[i] = NULL;
+    // Render current input, then the suggestion right after it
+    if (console->active) {
+        add_text(&batch, input_display, bg_x + margin, cam_h - 10 - text_h, white); // 10 pixels from bottom
+        if (console->suggestion[0] != '\0') {
+            add_text(&batch, console->suggestion, bg_x + margin + input_w, cam_h - 10 - text_h, gray);
         }
     }
-    if (console->input_texture) {
-        SDL_DestroyTexture(console->input_texture);
-        console->input_texture = NULL;
-    }
-    if (console->suggestion_texture) {
-        SDL_DestroyTexture(console->suggestion_texture);
-        console->suggestion_texture = NULL;
-    }
+    flush_text_batch(&batch);
 }
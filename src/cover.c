@@ -0,0 +1,155 @@
+#include "cover.h"
+#include "utils.h"
+#include "memtrack.h"
+
+// Builds the cover index: every walkable tile orthogonally adjacent to a small wall,
+// bucketed by the bin of the wall it hides behind.
+void build_cover_index(World* world) {
+    if (!world) {
+        printf("Error: Null world in build_cover_index\n");
+        return;
+    }
+
+    int directions[4][2] = {{0, 1}, {1, 0}, {0, -1}, {-1, 0}}; // Orthogonal directions
+    int bin_counts[COVER_BINS * COVER_BINS] = {0};
+    int count = 0;
+
+    // First pass: count cover points per bin
+    for (int y = 0; y < MAP_SIZE; y++) {
+        for (int x = 0; x < MAP_SIZE; x++) {
+            if (world->map[y][x] != WALL_SMALL) continue;
+            int bin = (y / COVER_BIN_TILES) * COVER_BINS + x / COVER_BIN_TILES;
+            for (int i = 0; i < 4; i++) {
+                if (!is_valid_node(x + directions[i][0], y + directions[i][1], world)) continue;
+                bin_counts[bin]++;
+                count++;
+            }
+        }
+    }
+
+    my_free(world->cover_points);
+    my_free(world->cover_cache.candidates);
+    world->cover_points = NULL;
+    world->cover_cache.candidates = NULL;
+    world->cover_count = 0;
+    world->cover_cache.count = 0;
+    world->cover_cache.version = -1;
+    if (count > 0) {
+        world->cover_points = (CoverPoint*)my_malloc(count * sizeof(CoverPoint));
+        world->cover_cache.candidates = (CoverCandidate*)my_malloc(count * sizeof(CoverCandidate));
+        if (!world->cover_points || !world->cover_cache.candidates) {
+            printf("Error: Failed to allocate cover index\n");
+            my_free(world->cover_points);
+            my_free(world->cover_cache.candidates);
+            world->cover_points = NULL;
+            world->cover_cache.candidates = NULL;
+            count = 0;
+        }
+    }
+
+    // Prefix sum gives each bin its slice of the cover point array
+    world->cover_bin_start[0] = 0;
+    for (int b = 0; b < COVER_BINS * COVER_BINS; b++) {
+        world->cover_bin_start[b + 1] = world->cover_bin_start[b] + (count > 0 ? bin_counts[b] : 0);
+    }
+
+    // Second pass: fill bins
+    if (count > 0) {
+        int cursor[COVER_BINS * COVER_BINS];
+        memcpy(cursor, world->cover_bin_start, sizeof(cursor));
+        for (int y = 0; y < MAP_SIZE; y++) {
+            for (int x = 0; x < MAP_SIZE; x++) {
+                if (world->map[y][x] != WALL_SMALL) continue;
+                int bin = (y / COVER_BIN_TILES) * COVER_BINS + x / COVER_BIN_TILES;
+                for (int i = 0; i < 4; i++) {
+                    int cx = x + directions[i][0];
+                    int cy = y + directions[i][1];
+                    if (!is_valid_node(cx, cy, world)) continue;
+                    world->cover_points[cursor[bin]++] = (CoverPoint){cx, cy, x, y, directions[i][0], directions[i][1]};
+                }
+            }
+        }
+    }
+
+    world->cover_count = count;
+    world->cover_version = world->map_version;
+}
+
+// Rebuilds the cover index if the map changed since it was last built
+void update_cover_index(World* world) {
+    if (world && world->cover_version != world->map_version) {
+        build_cover_index(world);
+    }
+}
+
+// Re-evaluates every cover point against the player tile if the player tile or the map changed.
+// Range band, line of sight and wall placement depend only on the two tiles, so the result is
+// shared by all enemies; each enemy only adds its own distance to the wall.
+void update_cover_cache(World* world, int player_x, int player_y) {
+    CoverCache* cache = &world->cover_cache;
+    update_cover_index(world);
+    if (cache->version == world->map_version && cache->player_x == player_x && cache->player_y == player_y) {
+        return;
+    }
+
+    float player_pixel_x = player_x * TILE_SIZE + TILE_SIZE / 2;
+    float player_pixel_y = player_y * TILE_SIZE + TILE_SIZE / 2;
+    int count = 0;
+
+    // Cover points are already sorted by bin, so compacting them keeps the bin order
+    for (int bin = 0; bin < COVER_BINS * COVER_BINS; bin++) {
+        cache->bin_start[bin] = count;
+        for (int k = world->cover_bin_start[bin]; k < world->cover_bin_start[bin + 1]; k++) {
+            CoverPoint* cp = &world->cover_points[k];
+            float cover_pixel_x = cp->x * TILE_SIZE + TILE_SIZE / 2;
+            float cover_pixel_y = cp->y * TILE_SIZE + TILE_SIZE / 2;
+            float player_dx = player_pixel_x - cover_pixel_x;
+            float player_dy = player_pixel_y - cover_pixel_y;
+            float player_dist_sq = player_dx * player_dx + player_dy * player_dy;
+
+            // Check if within shooting range
+            if (player_dist_sq < (SHOOTING_RANGE * 0.8f) * (SHOOTING_RANGE * 0.8f) ||
+                player_dist_sq > (SHOOTING_RANGE * 1.2f) * (SHOOTING_RANGE * 1.2f)) continue;
+
+            // Check line-of-sight (no BULLETPROOF or OPAQUE walls)
+            if (!has_line_of_sight(cover_pixel_x, cover_pixel_y, player_pixel_x, player_pixel_y, world, true, true)) {
+                continue;
+            }
+
+            // The wall sits one tile from the cover point against its normal, so it is between
+            // the cover point and the player when the normal faces away from the player
+            // and the player is farther than one tile
+            float dot_product = -(cp->normal_x * player_dx + cp->normal_y * player_dy);
+            bool wall_between = dot_product > 0 && TILE_SIZE * TILE_SIZE < player_dist_sq;
+
+            cache->candidates[count++] = (CoverCandidate){k, my_sqrt(player_dist_sq) * 0.5f, wall_between ? 0.5f : 1.0f};
+        }
+    }
+    cache->bin_start[COVER_BINS * COVER_BINS] = count;
+    cache->count = count;
+    cache->player_x = player_x;
+    cache->player_y = player_y;
+    cache->version = world->map_version;
+}
+
+// Computes the inclusive range of bins overlapping a circle around (x, y) in pixels
+void get_cover_bin_range(float x, float y, float radius, int* min_bx, int* min_by, int* max_bx, int* max_by) {
+    const float bin_size = COVER_BIN_TILES * TILE_SIZE;
+    *min_bx = (int)((x - radius) / bin_size);
+    *min_by = (int)((y - radius) / bin_size);
+    *max_bx = (int)((x + radius) / bin_size);
+    *max_by = (int)((y + radius) / bin_size);
+    if (x - radius < 0) *min_bx = 0;
+    if (y - radius < 0) *min_by = 0;
+    if (*max_bx >= COVER_BINS) *max_bx = COVER_BINS - 1;
+    if (*max_by >= COVER_BINS) *max_by = COVER_BINS - 1;
+}
+
+void free_cover_index(World* world) {
+    my_free(world->cover_points);
+    my_free(world->cover_cache.candidates);
+    world->cover_points = NULL;
+    world->cover_cache.candidates = NULL;
+    world->cover_count = 0;
+    world->cover_cache.count = 0;
+}
@@ -0,0 +1,17 @@
+#include "cull.h"
+
+// Converts the camera rect, grown by margin pixels on every side, to an inclusive tile range
+// clamped to the map. Returns false if the view does not overlap the map.
+bool get_view_tile_range(Camera* camera, float margin, int* min_tx, int* min_ty, int* max_tx, int* max_ty) {
+    float left = camera->x - margin, top = camera->y - margin;
+    float right = camera->x + camera->w + margin, bottom = camera->y + camera->h + margin;
+    if (right <= 0 || bottom <= 0 || left >= MAP_SIZE * TILE_SIZE || top >= MAP_SIZE * TILE_SIZE) return false;
+
+    *min_tx = left > 0 ? (int)(left / TILE_SIZE) : 0;
+    *min_ty = top > 0 ? (int)(top / TILE_SIZE) : 0;
+    *max_tx = (int)(right / TILE_SIZE);
+    *max_ty = (int)(bottom / TILE_SIZE);
+    if (*max_tx >= MAP_SIZE) *max_tx = MAP_SIZE - 1;
+    if (*max_ty >= MAP_SIZE) *max_ty = MAP_SIZE - 1;
+    return true;
+}
@@ -0,0 +1,152 @@
+#include "fog.h"
+#include "utils.h"
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+// Fog pixels in SDL_PIXELFORMAT_RGBA8888: gray with the alpha in the low byte. Because the colour
+// bytes never change, comparing two fog pixels as integers compares their alpha.
+#define FOG_PIXEL(alpha) (0x80808000u | (Uint32)(alpha))
+
+// Represents one polygon edge in the edge table
+typedef struct{
+    int y_start, y_end;// First and one-past-last scanline the edge crosses
+    float x;           // X at the current scanline's pixel centre
+    float dx_dy;       // X step per scanline
+} FogEdge;
+
+// Fills row[x0..x1) with one pixel value, four pixels per store where SSE2 is available
+static void fill_span(Uint32* row, int x0, int x1, Uint32 value) {
+    int x = x0;
+#if defined(__SSE2__)
+    __m128i v = _mm_set1_epi32((int)value);
+    for (; x < x1 && ((uintptr_t)(row + x) & 15); x++) row[x] = value;
+    for (; x + 4 <= x1; x += 4) _mm_store_si128((__m128i*)(row + x), v);
+#endif
+    for (; x < x1; x++) row[x] = value;
+}
+
+// Fills the whole buffer with fog (pitch in pixels)
+void clear_fog(Uint32* pixels, int pitch, int w, int h) {
+    for (int y = 0; y < h; y++) {
+        fill_span(pixels + y * pitch, 0, w, FOG_PIXEL(FOV_GRAY_ALPHA));
+    }
+}
+
+static int compare_fog_edges(const void* a, const void* b) {
+    return ((const FogEdge*)a)->y_start - ((const FogEdge*)b)->y_start;
+}
+
+// Writes the fade band part of a span. The ramp runs on squared distance, which over a thin band
+// is close to linear in distance and needs no square root per pixel.
+static void fade_span(Uint32* row, int x0, int x1, float dy, float cx, float fade_start_sq, float inv_fade_range_sq) {
+    for (int x = x0; x < x1; x++) {
+        float dx = x + 0.5f - cx;
+        float t = (dx * dx + dy * dy - fade_start_sq) * inv_fade_range_sq;
+        Uint32 value = FOG_PIXEL((int)(FOV_GRAY_ALPHA * maxf(0.0f, minf(t, 1.0f))));
+        if (value < row[x]) row[x] = value;
+    }
+}
+
+// Rasterises a fan polygon (the centre plus ray endpoints, in unscaled mask pixels) into a fog buffer
+// of scaled size w x h. Inside the polygon the fog is cleared out to fade_start and ramps back up to
+// full fog at fade_end; overlapping polygons keep the clearer pixel. Uses an edge table with an
+// active edge list so each scanline only touches the edges crossing it.
+void rasterize_fog_polygon(Uint32* pixels, int pitch, int w, int h, float scale, float cx, float cy,
+                           const float* cos_a, const float* sin_a, const float* dist, int rays,
+                           float fade_start, float fade_end) {
+    static FogEdge edges[FOV_MAX_RAYS + 2];
+    static FogEdge* active[FOV_MAX_RAYS + 2];
+    if (rays < 2 || rays > FOV_MAX_RAYS) return;
+
+    // Everything below works in scaled pixels
+    cx /= scale;
+    cy /= scale;
+    fade_start /= scale;
+    fade_end /= scale;
+
+    // Build the edge table: centre -> ray 0 -> ... -> ray n-1 -> centre
+    int edge_count = 0;
+    float prev_x = cx, prev_y = cy;
+    for (int i = 0; i <= rays; i++) {
+        float x = (i < rays) ? cx + cos_a[i] * dist[i] / scale : cx;
+        float y = (i < rays) ? cy + sin_a[i] * dist[i] / scale : cy;
+        float x0 = prev_x, y0 = prev_y, x1 = x, y1 = y;
+        prev_x = x;
+        prev_y = y;
+        if (y0 > y1) {
+            float tx = x0; x0 = x1; x1 = tx;
+            float ty = y0; y0 = y1; y1 = ty;
+        }
+        // Scanline centres at y + 0.5 inside [y0, y1)
+        int y_start = (int)(y0 - 0.5f + 1.0f - 1e-6f);
+        int y_end = (int)(y1 - 0.5f + 1.0f - 1e-6f);
+        if (y0 - 0.5f < 0.0f) y_start = 0;
+        if (y1 - 0.5f < 0.0f) y_end = 0;
+        if (y_start > h) y_start = h;
+        if (y_end > h) y_end = h;
+        if (y_end <= y_start) continue;
+        float dx_dy = (x1 - x0) / (y1 - y0);
+        edges[edge_count++] = (FogEdge){y_start, y_end, x0 + (y_start + 0.5f - y0) * dx_dy, dx_dy};
+    }
+    if (edge_count == 0) return;
+    qsort(edges, edge_count, sizeof(FogEdge), compare_fog_edges);
+
+    float fade_start_sq = fade_start * fade_start;
+    float inv_fade_range_sq = 1.0f / (fade_end * fade_end - fade_start_sq);
+    Uint32 clear = FOG_PIXEL(0);
+    int next_edge = 0, active_count = 0;
+
+    for (int y = edges[0].y_start; y < h; y++) {
+        // Add edges starting here, drop edges that ended
+        while (next_edge < edge_count && edges[next_edge].y_start <= y) active[active_count++] = &edges[next_edge++];
+        int kept = 0;
+        for (int i = 0; i < active_count; i++) {
+            if (active[i]->y_end > y) active[kept++] = active[i];
+        }
+        active_count = kept;
+        if (active_count == 0) {
+            if (next_edge >= edge_count) break;
+            continue;
+        }
+
+        // Insertion sort by x; the order barely changes between scanlines
+        for (int i = 1; i < active_count; i++) {
+            FogEdge* e = active[i];
+            int j = i - 1;
+            while (j >= 0 && active[j]->x > e->x) {
+                active[j + 1] = active[j];
+                j--;
+            }
+            active[j + 1] = e;
+        }
+
+        Uint32* row = pixels + y * pitch;
+        float dy = y + 0.5f - cy;
+        bool has_clear = dy * dy < fade_start_sq;
+        float half_clear = has_clear ? my_sqrt(fade_start_sq - dy * dy) : 0.0f;
+        int clear_x0 = has_clear ? (int)(cx - half_clear + 0.5f) : 0;
+        int clear_x1 = has_clear ? (int)(cx + half_clear + 0.5f) : 0;
+
+        for (int i = 0; i + 1 < active_count; i += 2) {
+            int x0 = (int)(active[i]->x + 0.5f);
+            int x1 = (int)(active[i + 1]->x + 0.5f);
+            if (active[i]->x + 0.5f < 0.0f) x0 = 0;
+            if (active[i + 1]->x + 0.5f < 0.0f) x1 = 0;
+            if (x1 > w) x1 = w;
+            if (x0 >= x1) continue;
+
+            if (!has_clear || clear_x1 <= x0 || clear_x0 >= x1) {
+                fade_span(row, x0, x1, dy, cx, fade_start_sq, inv_fade_range_sq);
+                continue;
+            }
+            int cx0 = clear_x0 > x0 ? clear_x0 : x0;
+            int cx1 = clear_x1 < x1 ? clear_x1 : x1;
+            fade_span(row, x0, cx0, dy, cx, fade_start_sq, inv_fade_range_sq);
+            fill_span(row, cx0, cx1, clear);
+            fade_span(row, cx1, x1, dy, cx, fade_start_sq, inv_fade_range_sq);
+        }
+
+        for (int i = 0; i < active_count; i++) active[i]->x += active[i]->dx_dy;
+    }
+}
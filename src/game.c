@@ -2,6 +2,47 @@
 #include "render.h"
 #include "utils.h"
 #include "pathfinding.h"
+#include "influence.h"
+#include "random.h"
+#include "profiler.h"
+#include "trace.h"
+#include "memtrack.h"
+
+float fixed_dt = FIXED_DT;
+
+// Sets the simulation tick rate. Anything moved or timed per fixed update scales with fixed_dt,
+// so a lower rate (e.g. 30 Hz with large crowds) only costs precision; rendering interpolates
+// between ticks. Returns false and keeps the current rate if hz is out of range.
+bool set_sim_rate(int hz) {
+    if (hz < SIM_RATE_MIN || hz > SIM_RATE_MAX) return false;
+    fixed_dt = 1.0f / (float)hz;
+    return true;
+}
+
+// Records the transforms every moving object starts the coming fixed update from
+void save_previous_transforms(Player* player, Enemy* enemies, Bullet* bullets) {
+    player->prev_x = player->x;
+    player->prev_y = player->y;
+    player->prev_angle = player->angle;
+    for (int i = 0; i < MAX_ENEMIES; i++) {
+        enemies[i].prev_x = enemies[i].x;
+        enemies[i].prev_y = enemies[i].y;
+        enemies[i].prev_angle = enemies[i].angle;
+    }
+    for (int i = 0; i < MAX_BULLETS; i++) {
+        bullets[i].prev_x = bullets[i].x;
+        bullets[i].prev_y = bullets[i].y;
+    }
+}
+
+// Returns a copy of the player placed alpha (0-1) of the way from its previous to its current transform
+Player interpolate_player(const Player* player, float alpha) {
+    Player view = *player;
+    view.x = player->prev_x + (player->x - player->prev_x) * alpha;
+    view.y = player->prev_y + (player->y - player->prev_y) * alpha;
+    view.angle = lerp_angle(player->prev_angle, player->angle, alpha);
+    return view;
+}
 
 void update_camera(Camera* camera, Player* player, World* world, SDL_Renderer* renderer) {
     if (!renderer) {
@@ -19,8 +60,11 @@ void update_camera(Camera* camera, Player* player, World* world, SDL_Renderer* r
             camera->h = renderer_h;
         }
     }
+    center_camera(camera, player, world);
+}
 
-    // Center camera on player's exact center
+// Centres a camera of known size on the player, clamped to the world
+void center_camera(Camera* camera, Player* player, World* world) {
     float player_center_x = player->x + player->w / 2.0f;
     float player_center_y = player->y + player->h / 2.0f;
     camera->x = player_center_x - (camera->w / 2.0f);
@@ -33,7 +77,16 @@ void update_camera(Camera* camera, Player* player, World* world, SDL_Renderer* r
     if (camera->y + camera->h > world->h) camera->y = world->h - camera->h;
 }
 
-void update_player_angle(Camera* camera, Player* player){
+// Fills input from the keyboard and mouse. Main thread only: the mouse is aimed at what is on
+// screen, so the angle is taken from the camera and player as they were last drawn.
+void read_player_input(PlayerInput* input, const Camera* camera, const Player* player){
+    const Uint8* keyboard_state = SDL_GetKeyboardState(NULL);
+    input->move_x = input->move_y = 0.0f;
+    if (keyboard_state[SDL_SCANCODE_W]) input->move_y -= 1.0f;
+    if (keyboard_state[SDL_SCANCODE_S]) input->move_y += 1.0f;
+    if (keyboard_state[SDL_SCANCODE_A]) input->move_x -= 1.0f;
+    if (keyboard_state[SDL_SCANCODE_D]) input->move_x += 1.0f;
+
     int mouse_x, mouse_y;
     SDL_GetMouseState(&mouse_x, &mouse_y);
     float world_mouse_x = mouse_x + camera->x;
@@ -42,8 +95,13 @@ void update_player_angle(Camera* camera, Player* player){
     float gun_pivot_y = player->y + player->h / 2;
     float dx = world_mouse_x - gun_pivot_x;
     float dy = world_mouse_y - gun_pivot_y;
-    float target_angle = my_atan2f(dy, dx) * (180.0f / MA_PI);
+    input->aim = true;
+    input->turn_limited = true;
+    input->angle = my_atan2f(dy, dx) * (180.0f / MA_PI);
+}
 
+// Turns the player towards target_angle by at most MAX_PLAYER_ROTATION
+static void turn_player_towards(Player* player, float target_angle){
 	float angle_diff = target_angle - player->angle;
 	while(angle_diff > 180.0f) angle_diff -= 360.0f;
 	while(angle_diff < -180.0f) angle_diff += 360.0f;
@@ -66,6 +124,8 @@ void spawn_bullet(Bullet* bullets, Entity* entity, int owner) {
         if (!bullets[i].active) {
             bullets[i].x = entity->x + entity->w / 2 + cos_a * (entity->w / 2);
             bullets[i].y = entity->y + entity->h / 2 + sin_a * (entity->h / 2);
+            bullets[i].prev_x = bullets[i].x; // Appears in place rather than sliding in
+            bullets[i].prev_y = bullets[i].y;
             bullets[i].vel_x = cos_a * BULLET_SPEED;
             bullets[i].vel_y = sin_a * BULLET_SPEED;
             bullets[i].lifetime = BULLET_LIFETIME;
@@ -105,29 +165,81 @@ void update_bullets(Bullet* bullets, World* world, float dt) {
     }
 }
 
-void fixed_update_player(Player* player, World* world, Bullet* bullets, Camera* camera, Console* console) {
-    const Uint8* keyboard_state = SDL_GetKeyboardState(NULL);
+// Moves a box by its velocity, each axis only if that doesn't take it into a blocking wall, then
+// keeps it inside the world. The box is inset 10 pixels on each side, so sprites can overlap
+// walls a little.
+void move_with_wall_collision(float* x, float* y, float w, float h, float vel_x, float vel_y, World* world) {
+    float next_x = *x + vel_x;
+    float next_y = *y + vel_y;
+    bool collide_x = false, collide_y = false;
+    for (int i = 0; i < world->wall_count; i++) {
+        if (world->walls[i].type != WALL_NONE && world->walls[i].type != WALL_SMALL) {
+            if (check_collision(next_x + 10, *y + 10, w - 20, h - 20,
+                                world->walls[i].x, world->walls[i].y, world->walls[i].w, world->walls[i].h)) {
+                collide_x = true;
+            }
+            if (check_collision(*x + 10, next_y + 10, w - 20, h - 20,
+                                world->walls[i].x, world->walls[i].y, world->walls[i].w, world->walls[i].h)) {
+                collide_y = true;
+            }
+        }
+    }
+    if (!collide_x) *x = next_x;
+    if (!collide_y) *y = next_y;
+
+    if (*x < 0) *x = 0;
+    if (*x + w > world->w) *x = world->w - w;
+    if (*y < 0) *y = 0;
+    if (*y + h > world->h) *y = world->h - h;
+}
+
+// Applies every player bullet inside the enemy's radius to it, killing it once its hp runs out
+void hit_enemy_with_bullets(Enemy* enemy, Bullet* bullets) {
+    for (int j = 0; j < MAX_BULLETS; j++) {
+        if (bullets[j].active && bullets[j].owner == 1) {
+            float bdx = bullets[j].x - (enemy->x + enemy->w / 2);
+            float bdy = bullets[j].y - (enemy->y + enemy->h / 2);
+            if (my_sqrt(bdx * bdx + bdy * bdy) < enemy->w / 2) {
+                bullets[j].active = false;
+                float damage = enemy->in_cover ? 5.0f : 10.0f;
+                enemy->hp -= damage;
+                if (enemy->hp <= 0.0f) {
+                    enemy->active = false;
+                    enemy->respawn_timer = ENEMY_RESPAWN_DELAY;
+                    enemy->state = FREE;
+                    enemy->in_cover = false;
+                }
+            }
+        }
+    }
+}
+
+// Runs one fixed update of the player from input that needs no window, so scripted
+// players (e.g. the headless bench) move through exactly the same code as the keyboard
+void apply_player_input(Player* player, World* world, Bullet* bullets, const PlayerInput* input) {
+    PROFILE_BEGIN(PROFILE_PLAYER);
     float speed = 300.0f;
-    float friction = 0.9f;
-    float vel_input_x = 0.0f, vel_input_y = 0.0f;
-
-    if (!console->active) {
-        if (keyboard_state[SDL_SCANCODE_W]) vel_input_y -= speed * FIXED_DT;
-        if (keyboard_state[SDL_SCANCODE_S]) vel_input_y += speed * FIXED_DT;
-        if (keyboard_state[SDL_SCANCODE_A]) vel_input_x -= speed * FIXED_DT;
-        if (keyboard_state[SDL_SCANCODE_D]) vel_input_x += speed * FIXED_DT;
-        update_player_angle(camera, player);
+    // Friction keeps 90% of the velocity per 1/60 s, whatever the tick rate
+    float friction = SDL_powf(0.9f, fixed_dt * 60.0f);
+
+    if (input->aim) {
+        if (input->turn_limited) turn_player_towards(player, input->angle);
+        else player->angle = input->angle;
+    }
+    if (input->fire) {
+        Entity player_entity = {player->x, player->y, player->w, player->h, player->angle, {0}, 0};
+        spawn_bullet(bullets, &player_entity, 1);
     }
 
-    player->vel_x += vel_input_x;
-    player->vel_y += vel_input_y;
+    player->vel_x += input->move_x * speed * fixed_dt;
+    player->vel_y += input->move_y * speed * fixed_dt;
     player->vel_x *= friction;
     player->vel_y *= friction;
 
     float length = my_sqrt(player->vel_x * player->vel_x + player->vel_y * player->vel_y);
-    if (length > speed * FIXED_DT && length > 0.0f) {
-        player->vel_x = (player->vel_x / length) * speed * FIXED_DT;
-        player->vel_y = (player->vel_y / length) * speed * FIXED_DT;
+    if (length > speed * fixed_dt && length > 0.0f) {
+        player->vel_x = (player->vel_x / length) * speed * fixed_dt;
+        player->vel_y = (player->vel_y / length) * speed * fixed_dt;
     }
 
 	// Calculate temporary next position for small wall check
@@ -148,39 +260,29 @@ void fixed_update_player(Player* player, World* world, Bullet* bullets, Camera*
 
 	// Halve velocity if intersecting a small wall
 	if (in_small_wall) {
-		player->vel_x *= 0.25f;
-		player->vel_y *= 0.25f;
+		float slowdown = SDL_powf(0.25f, fixed_dt * 60.0f);
+		player->vel_x *= slowdown;
+		player->vel_y *= slowdown;
 	}
 
-    float next_x = player->x + player->vel_x;
-    float next_y = player->y + player->vel_y;
-    bool collide_x = false, collide_y = false;
-
 	// Wall colision
-    for (int i = 0; i < world->wall_count; i++) {
-        if (world->walls[i].type != WALL_NONE && world->walls[i].type != WALL_SMALL){
-			if(check_collision(next_x + 10, player->y + 10, player->w - 20, player->h - 20,
-								world->walls[i].x, world->walls[i].y,
-								world->walls[i].w, world->walls[i].h)) {
-				collide_x = true;
-			}
-			if (check_collision(player->x + 10, next_y + 10, player->w - 20, player->h - 20,
-								world->walls[i].x, world->walls[i].y,
-								world->walls[i].w, world->walls[i].h)) {
-				collide_y = true;
-			}
-		}
-    }
+    move_with_wall_collision(&player->x, &player->y, player->w, player->h, player->vel_x, player->vel_y, world);
 
-    if (!collide_x) player->x += player->vel_x;
-    if (!collide_y) player->y += player->vel_y;
-
-    if (player->x < 0) player->x = 0;
-    if (player->x + player->w > world->w) player->x = world->w - player->w;
-    if (player->y < 0) player->y = 0;
-    if (player->y + player->h > world->h) player->y = world->h - player->h;
+    PROFILE_BEGIN(PROFILE_BULLETS);
+    update_bullets(bullets, world, fixed_dt);
+    PROFILE_END(PROFILE_BULLETS);
+    PROFILE_END(PROFILE_PLAYER);
+}
 
-    update_bullets(bullets, world, FIXED_DT);
+// Plans a path for an enemy to a tile and stores it on the enemy, adding the time to profile
+static void plan_path(Enemy* enemy, Entity* entity, World* world, int target_x, int target_y, ProfileSum* profile) {
+    PROFILE_BEGIN(PROFILE_PATHFINDING);
+    TRACE_BEGIN(path);
+    int nodes = find_path(entity, world, target_x, target_y);
+    TRACE_END(path, "find_path", 2, "nodes", nodes, "length", entity->path_length);
+    PROFILE_SUM_END(profile, PROFILE_PATHFINDING);
+    memcpy(enemy->path, entity->path, sizeof(enemy->path));
+    enemy->path_length = entity->path_length;
 }
 
 void fixed_update_enemies(Player* player, World* world, Bullet* bullets, Enemy* enemies, Camera* camera, GameState* game_state) {
@@ -192,12 +294,16 @@ void fixed_update_enemies(Player* player, World* world, Bullet* bullets, Enemy*
     static float search_timer[MAX_ENEMIES] = {0.0f};
     static float look_around_timer[MAX_ENEMIES] = {0.0f};
     static float base_angle[MAX_ENEMIES] = {0.0f};
+    ProfileSum profile = {0}; // Per-enemy zones, recorded once at the end of the tick
+    note_stack_depth(STACK_TICK);
 
     // Flag & spawn logic
+    PROFILE_BEGIN(PROFILE_ENEMIES);
+    PROFILE_BEGIN(PROFILE_SPAWN);
     if (game_state->spawn_enabled) {
         for (int i = 0; i < world->flag_count; i++) {
             if (!world->flags[i].active) continue;
-            world->flags[i].spawn_timer -= FIXED_DT;
+            world->flags[i].spawn_timer -= fixed_dt;
             if (world->flags[i].spawn_timer <= 0.0f &&
                 world->flags[i].enemies_spawned < world->flags[i].enemy_count) {
                 for (int j = 0; j < MAX_ENEMIES &&
@@ -212,12 +318,19 @@ void fixed_update_enemies(Player* player, World* world, Bullet* bullets, Enemy*
         }
     }
 
+    PROFILE_END(PROFILE_SPAWN);
+
+    // Shared tactical picture for this update
+    PROFILE_BEGIN(PROFILE_INFLUENCE);
+    update_influence_map(world, player, enemies);
+    PROFILE_END(PROFILE_INFLUENCE);
+
     // Enemy update loop
     for (int i = 0; i < MAX_ENEMIES; i++) {
         if (!enemies[i].active) {
             // handle respawn countdown
             if (game_state->spawn_enabled && enemies[i].respawn_timer > 0.0f) {
-                enemies[i].respawn_timer -= FIXED_DT;
+                enemies[i].respawn_timer -= fixed_dt;
                 if (enemies[i].respawn_timer <= 0.0f &&
                     enemies[i].flag_id >= 0 &&
                     enemies[i].flag_id < world->flag_count) {
@@ -228,6 +341,7 @@ void fixed_update_enemies(Player* player, World* world, Bullet* bullets, Enemy*
         }
 
         // AI perception
+        PROFILE_BEGIN(PROFILE_DECISIONS);
         float dx = (player->x + player->w / 2) - (enemies[i].x + enemies[i].w / 2);
         float dy = (player->y + player->h / 2) - (enemies[i].y + enemies[i].h / 2);
         float distance = my_sqrt(dx * dx + dy * dy);
@@ -256,14 +370,16 @@ void fixed_update_enemies(Player* player, World* world, Bullet* bullets, Enemy*
         int target_y = (int)avg_target_y;
 
         // timers
-        enemies[i].decision_timer -= FIXED_DT;
-        enemies[i].shoot_timer -= FIXED_DT;
+        enemies[i].decision_timer -= fixed_dt;
+        enemies[i].shoot_timer -= fixed_dt;
         if (enemies[i].state == SEARCHING) {
-            search_timer[i] -= FIXED_DT;
+            search_timer[i] -= fixed_dt;
         }
 
         // Decision making
         if (enemies[i].decision_timer <= 0.0f || enemies[i].force_path_recalc) {
+            TRACE_BEGIN(decision);
+            EnemyState previous_state = enemies[i].state;
             enemies[i].decision_timer = DECISION_INTERVAL;
 
             bool has_los = has_line_of_sight(
@@ -294,9 +410,7 @@ void fixed_update_enemies(Player* player, World* world, Bullet* bullets, Enemy*
                         float dy_target = target_world_y - (enemies[i].y + enemies[i].h / 2);
                         base_angle[i] = my_atan2f(dy_target, dx_target) * (180.0f / MA_PI);
 
-                        find_path(&enemy_entity, world, last_target_x[i], last_target_y[i]);
-                        memcpy(enemies[i].path, enemy_entity.path, sizeof(enemies[i].path));
-                        enemies[i].path_length = enemy_entity.path_length;
+                        plan_path(&enemies[i], &enemy_entity, world, last_target_x[i], last_target_y[i], &profile);
                     } else {
                         enemies[i].path_length = 0;
                     }
@@ -310,35 +424,47 @@ void fixed_update_enemies(Player* player, World* world, Bullet* bullets, Enemy*
                     last_target_x[i] = -1;
                     last_target_y[i] = -1;
                 } else if (enemies[i].state == FREE) {
-                    if (enemies[i].path_length == 0) {
-                        if ((rand() % 5) == 0) {
+                    int enemy_tile_x = (int)((enemies[i].x + enemies[i].w / 2) / TILE_SIZE);
+                    int enemy_tile_y = (int)((enemies[i].y + enemies[i].h / 2) / TILE_SIZE);
+                    int seen_x, seen_y;
+                    if (get_influence(world, INFLUENCE_LAST_SEEN, enemy_tile_x, enemy_tile_y) > LAST_SEEN_ALERT_LEVEL &&
+                        get_last_seen_position(world, &seen_x, &seen_y)) {
+                        // Another enemy saw the player nearby recently, join the search
+                        enemies[i].state = SEARCHING;
+                        search_timer[i] = 5.0f;
+                        float dx_target = (seen_x * TILE_SIZE + TILE_SIZE / 2) - (enemies[i].x + enemies[i].w / 2);
+                        float dy_target = (seen_y * TILE_SIZE + TILE_SIZE / 2) - (enemies[i].y + enemies[i].h / 2);
+                        base_angle[i] = my_atan2f(dy_target, dx_target) * (180.0f / MA_PI);
+                        plan_path(&enemies[i], &enemy_entity, world, seen_x, seen_y, &profile);
+                        last_target_x[i] = seen_x;
+                        last_target_y[i] = seen_y;
+                    } else if (enemies[i].path_length == 0) {
+                        if (random_below(&enemies[i].wander_random, 5) == 0) {
                             int walk_range_min = 3;
                             int walk_range_max = 10;
-                            int enemy_tile_x = (int)((enemies[i].x + enemies[i].w / 2) / TILE_SIZE);
-                            int enemy_tile_y = (int)((enemies[i].y + enemies[i].h / 2) / TILE_SIZE);
                             int attempts = 0;
                             int max_attempts = 10;
                             int walk_x, walk_y;
                             bool valid_walk = false;
 
                             while (!valid_walk && attempts < max_attempts) {
-                                int walk_distance = (rand() % (walk_range_max - walk_range_min + 1)) + walk_range_min;
-                                int angle = rand() % 360;
+                                int walk_distance = random_below(&enemies[i].wander_random, walk_range_max - walk_range_min + 1) + walk_range_min;
+                                int angle = random_below(&enemies[i].wander_random, 360);
                                 int dx = (int)(my_cosf(angle * MA_PI / 180.0f) * walk_distance);
                                 int dy = (int)(my_sinf(angle * MA_PI / 180.0f) * walk_distance);
                                 walk_x = enemy_tile_x + dx;
                                 walk_y = enemy_tile_y + dy;
 
-                                if (is_valid_node(walk_x, walk_y, world)) {
+                                // Don't wander into the player's sight cone
+                                if (is_valid_node(walk_x, walk_y, world) &&
+                                    get_influence(world, INFLUENCE_THREAT, walk_x, walk_y) < THREAT_AVOID_LEVEL) {
                                     valid_walk = true;
                                 }
                                 attempts++;
                             }
 
                             if (valid_walk) {
-                                find_path(&enemy_entity, world, walk_x, walk_y);
-                                memcpy(enemies[i].path, enemy_entity.path, sizeof(enemies[i].path));
-                                enemies[i].path_length = enemy_entity.path_length;
+                                plan_path(&enemies[i], &enemy_entity, world, walk_x, walk_y, &profile);
                                 last_target_x[i] = walk_x;
                                 last_target_y[i] = walk_y;
                             }
@@ -350,16 +476,17 @@ void fixed_update_enemies(Player* player, World* world, Bullet* bullets, Enemy*
                 if (enemies[i].state == FREE || enemies[i].state == SEARCHING) {
                     enemies[i].path_length = 0;
                 }
+                report_player_seen(world, target_x, target_y);
 
                 int cover_x, cover_y;
+                PROFILE_BEGIN(PROFILE_COVER);
                 find_cover_point(&enemies[i], world, target_x, target_y, &cover_x, &cover_y);
+                PROFILE_SUM_END(&profile, PROFILE_COVER);
 
                 if (distance < SHOOTING_RANGE) {
                     if (cover_x != -1 && cover_y != -1) {
                         enemies[i].state = TAKE_COVER;
-                        find_path(&enemy_entity, world, cover_x, cover_y);
-                        memcpy(enemies[i].path, enemy_entity.path, sizeof(enemies[i].path));
-                        enemies[i].path_length = enemy_entity.path_length;
+                        plan_path(&enemies[i], &enemy_entity, world, cover_x, cover_y, &profile);
                         enemies[i].in_cover = true;
                     } else {
                         enemies[i].state = SHOOT;
@@ -368,9 +495,7 @@ void fixed_update_enemies(Player* player, World* world, Bullet* bullets, Enemy*
                     }
                 } else {
                     enemies[i].state = CHASE;
-                    find_path(&enemy_entity, world, target_x, target_y);
-                    memcpy(enemies[i].path, enemy_entity.path, sizeof(enemies[i].path));
-                    enemies[i].path_length = enemy_entity.path_length;
+                    plan_path(&enemies[i], &enemy_entity, world, target_x, target_y, &profile);
                     enemies[i].in_cover = false;
                 }
                 last_target_x[i] = target_x;
@@ -378,11 +503,14 @@ void fixed_update_enemies(Player* player, World* world, Bullet* bullets, Enemy*
             }
             enemies[i].path_timer = PATHFINDING_INTERVAL;
             enemies[i].force_path_recalc = false;
+            TRACE_END(decision, "decision", 3, "enemy", i, "from", previous_state, "to", enemies[i].state);
         }
+        PROFILE_SUM_END(&profile, PROFILE_DECISIONS);
 
         // Searching animation
+        PROFILE_BEGIN(PROFILE_MOVEMENT);
         if (enemies[i].state == SEARCHING && enemies[i].path_length == 0) {
-            look_around_timer[i] += FIXED_DT;
+            look_around_timer[i] += fixed_dt;
             float look_angle = base_angle[i] + 45.0f * my_sinf(2.0f * MA_PI * look_around_timer[i] / 2.0f);
             enemies[i].angle = look_angle;
             if (enemies[i].angle >= 360.0f) enemies[i].angle -= 360.0f;
@@ -409,48 +537,14 @@ void fixed_update_enemies(Player* player, World* world, Bullet* bullets, Enemy*
         move_along_path(&enemies[i], world, i, last_target_x[i], last_target_y[i]);
 
         // Wall collision
-        float e_next_x = enemies[i].x + enemies[i].vel_x;
-        float e_next_y = enemies[i].y + enemies[i].vel_y;
-        bool collide_x = false, collide_y = false;
-        for (int j = 0; j < world->wall_count; j++) {
-            if (world->walls[j].type != WALL_NONE && world->walls[j].type != WALL_SMALL){
-				if(check_collision(e_next_x + 10, enemies[i].y + 10, enemies[i].w - 20, enemies[i].h - 20,
-									world->walls[j].x, world->walls[j].y,
-									world->walls[j].w, world->walls[j].h)) {
-					collide_x = true;
-				}
-				if(check_collision(enemies[i].x + 10, e_next_y + 10, enemies[i].w - 20, enemies[i].h - 20,
-									world->walls[j].x, world->walls[j].y,
-									world->walls[j].w, world->walls[j].h)) {
-					collide_y = true;
-				}
-			}
-        }
-        if (!collide_x) enemies[i].x = e_next_x;
-        if (!collide_y) enemies[i].y = e_next_y;
-
-        if (enemies[i].x < 0) enemies[i].x = 0;
-        if (enemies[i].x + enemies[i].w > world->w) enemies[i].x = world->w - enemies[i].w;
-        if (enemies[i].y < 0) enemies[i].y = 0;
-        if (enemies[i].y + enemies[i].h > world->h) enemies[i].y = world->h - enemies[i].h;
+        move_with_wall_collision(&enemies[i].x, &enemies[i].y, enemies[i].w, enemies[i].h, enemies[i].vel_x, enemies[i].vel_y, world);
+        PROFILE_SUM_END(&profile, PROFILE_MOVEMENT);
 
         // Check bullet hits
-        for (int j = 0; j < MAX_BULLETS; j++) {
-            if (bullets[j].active && bullets[j].owner == 1) {
-                float bdx = bullets[j].x - (enemies[i].x + enemies[i].w / 2);
-                float bdy = bullets[j].y - (enemies[i].y + enemies[i].h / 2);
-                if (my_sqrt(bdx * bdx + bdy * bdy) < enemies[i].w / 2) {
-                    bullets[j].active = false;
-                    float damage = enemies[i].in_cover ? 5.0f : 10.0f;
-                    enemies[i].hp -= damage;
-                    if (enemies[i].hp <= 0.0f) {
-                        enemies[i].active = false;
-                        enemies[i].respawn_timer = ENEMY_RESPAWN_DELAY;
-                        enemies[i].state = FREE;
-                        enemies[i].in_cover = false;
-                    }
-                }
-            }
-        }
+        PROFILE_BEGIN(PROFILE_HITS);
+        hit_enemy_with_bullets(&enemies[i], bullets);
+        PROFILE_SUM_END(&profile, PROFILE_HITS);
     }
+    PROFILE_RECORD_SUM(&profile);
+    PROFILE_END(PROFILE_ENEMIES);
 }
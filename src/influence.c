@@ -0,0 +1,142 @@
+#include "influence.h"
+#include "utils.h"
+#include "raycast.h"
+#include "memtrack.h"
+
+void init_influence_map(World* world) {
+    if (!world) {
+        printf("Error: Null world in init_influence_map\n");
+        return;
+    }
+    my_free(world->influence);
+    world->influence = (InfluenceMap*)my_calloc(1, sizeof(InfluenceMap));
+    if (!world->influence) {
+        printf("Error: Failed to allocate influence map\n");
+        return;
+    }
+    world->influence->last_seen_x = -1;
+    world->influence->last_seen_y = -1;
+}
+
+// Returns whether a tile centre lies in the player's sight cone, ignoring walls
+static bool tile_in_player_cone(int x, int y, float player_x, float player_y, float player_angle) {
+    float tile_x = x * TILE_SIZE + TILE_SIZE / 2;
+    float tile_y = y * TILE_SIZE + TILE_SIZE / 2;
+    float dx = tile_x - player_x;
+    float dy = tile_y - player_y;
+    if (dx * dx + dy * dy > FOV_RANGE * FOV_RANGE) return false;
+
+    float angle_diff = my_atan2f(dy, dx) * (180.0f / MA_PI) - player_angle;
+    while (angle_diff > 180.0f) angle_diff -= 360.0f;
+    while (angle_diff < -180.0f) angle_diff += 360.0f;
+    return absf(angle_diff) <= FOV_HALF_ANGLE;
+}
+
+// Stamps enemy positions every update and refreshes a band of rows. Each tile's influence
+// spreads to its walkable neighbours with a falloff per tile; threat and density ease toward the
+// propagated value, while the last known player position fades linearly over time.
+// The whole map is refreshed every MAP_SIZE / INFLUENCE_ROWS_PER_TICK updates.
+void update_influence_map(World* world, Player* player, Enemy* enemies) {
+    InfluenceMap* im = world->influence;
+    if (!im) return;
+
+    memset(im->enemy_count, 0, sizeof(im->enemy_count));
+    for (int i = 0; i < MAX_ENEMIES; i++) {
+        if (!enemies[i].active) continue;
+        int tx = (int)((enemies[i].x + enemies[i].w / 2) / TILE_SIZE);
+        int ty = (int)((enemies[i].y + enemies[i].h / 2) / TILE_SIZE);
+        if (tx < 0 || tx >= MAP_SIZE || ty < 0 || ty >= MAP_SIZE) continue;
+        if (im->enemy_count[ty][tx] < 255) im->enemy_count[ty][tx]++;
+    }
+
+    // The last-seen position is stamped immediately so enemies can react this update
+    if (im->player_seen) {
+        im->layers[INFLUENCE_LAST_SEEN][im->last_seen_y][im->last_seen_x] = 1.0f;
+        im->player_seen = false;
+    }
+
+    float player_x = player->x + player->w / 2.0f;
+    float player_y = player->y + player->h / 2.0f;
+    float refresh_interval = fixed_dt * (MAP_SIZE / INFLUENCE_ROWS_PER_TICK);
+    float memory_fade = refresh_interval / INFLUENCE_MEMORY_TIME;
+    int directions[4][2] = {{0, 1}, {1, 0}, {0, -1}, {-1, 0}};
+
+    int end_row = im->next_row + INFLUENCE_ROWS_PER_TICK;
+    if (end_row > MAP_SIZE) end_row = MAP_SIZE;
+
+    // Threat sources: tiles of the band inside the player's cone, checked for opaque walls in one
+    // ray batch. Rays aim at tile centres, so a distance below 1 means a wall was hit first.
+    static bool in_sight[INFLUENCE_ROWS_PER_TICK][MAP_SIZE];
+    static float ray_dx[INFLUENCE_ROWS_PER_TICK * MAP_SIZE], ray_dy[INFLUENCE_ROWS_PER_TICK * MAP_SIZE];
+    static float ray_dist[INFLUENCE_ROWS_PER_TICK * MAP_SIZE];
+    static int ray_tile[INFLUENCE_ROWS_PER_TICK * MAP_SIZE];
+    int ray_count = 0;
+    memset(in_sight, 0, sizeof(in_sight));
+    for (int y = im->next_row; y < end_row; y++) {
+        for (int x = 0; x < MAP_SIZE; x++) {
+            if (!is_valid_node(x, y, world) || !tile_in_player_cone(x, y, player_x, player_y, player->angle)) continue;
+            ray_dx[ray_count] = x * TILE_SIZE + TILE_SIZE / 2 - player_x;
+            ray_dy[ray_count] = y * TILE_SIZE + TILE_SIZE / 2 - player_y;
+            ray_tile[ray_count++] = (y - im->next_row) * MAP_SIZE + x;
+        }
+    }
+    cast_rays(player_x, player_y, ray_dx, ray_dy, ray_count, 1.0f, RAY_BLOCK(WALL_OPAQUE), world, ray_dist, NULL);
+    for (int i = 0; i < ray_count; i++) {
+        if (ray_dist[i] >= 1.0f) in_sight[ray_tile[i] / MAP_SIZE][ray_tile[i] % MAP_SIZE] = true;
+    }
+    for (int y = im->next_row; y < end_row; y++) {
+        for (int x = 0; x < MAP_SIZE; x++) {
+            if (!is_valid_node(x, y, world)) {
+                for (int l = 0; l < INFLUENCE_LAYER_COUNT; l++) im->layers[l][y][x] = 0.0f;
+                continue;
+            }
+
+            float spread[INFLUENCE_LAYER_COUNT] = {0.0f};
+            for (int i = 0; i < 4; i++) {
+                int nx = x + directions[i][0];
+                int ny = y + directions[i][1];
+                if (!is_valid_node(nx, ny, world)) continue;
+                for (int l = 0; l < INFLUENCE_LAYER_COUNT; l++) spread[l] = maxf(spread[l], im->layers[l][ny][nx]);
+            }
+
+            float threat = in_sight[y - im->next_row][x] ? 1.0f : 0.0f;
+            float threat_target = maxf(threat, spread[INFLUENCE_THREAT] * INFLUENCE_FALLOFF);
+            float density_target = maxf((float)im->enemy_count[y][x], spread[INFLUENCE_DENSITY] * INFLUENCE_FALLOFF);
+            float* threat_value = &im->layers[INFLUENCE_THREAT][y][x];
+            float* density_value = &im->layers[INFLUENCE_DENSITY][y][x];
+            float* last_seen_value = &im->layers[INFLUENCE_LAST_SEEN][y][x];
+            *threat_value += (threat_target - *threat_value) * INFLUENCE_MOMENTUM;
+            *density_value += (density_target - *density_value) * INFLUENCE_MOMENTUM;
+            *last_seen_value = maxf(0.0f, maxf(*last_seen_value, spread[INFLUENCE_LAST_SEEN] * INFLUENCE_MEMORY_FALLOFF) - memory_fade);
+        }
+    }
+    im->next_row = (end_row >= MAP_SIZE) ? 0 : end_row;
+}
+
+// Records that an enemy saw the player on the given tile
+void report_player_seen(World* world, int tile_x, int tile_y) {
+    InfluenceMap* im = world->influence;
+    if (!im || tile_x < 0 || tile_x >= MAP_SIZE || tile_y < 0 || tile_y >= MAP_SIZE) return;
+    im->last_seen_x = tile_x;
+    im->last_seen_y = tile_y;
+    im->player_seen = true;
+}
+
+// Returns the tile where the player was last seen, if that memory has not faded yet
+bool get_last_seen_position(World* world, int* tile_x, int* tile_y) {
+    InfluenceMap* im = world->influence;
+    if (!im || im->last_seen_x < 0 || im->layers[INFLUENCE_LAST_SEEN][im->last_seen_y][im->last_seen_x] <= 0.0f) return false;
+    *tile_x = im->last_seen_x;
+    *tile_y = im->last_seen_y;
+    return true;
+}
+
+float get_influence(World* world, InfluenceLayer layer, int tile_x, int tile_y) {
+    if (!world->influence || tile_x < 0 || tile_x >= MAP_SIZE || tile_y < 0 || tile_y >= MAP_SIZE) return 0.0f;
+    return world->influence->layers[layer][tile_y][tile_x];
+}
+
+void free_influence_map(World* world) {
+    my_free(world->influence);
+    world->influence = NULL;
+}
@@ -6,15 +6,59 @@
 #include "pathfinding.h"
 #include "command.h"
 #include "menu.h"
+#include "cover.h"
+#include "influence.h"
+#include "chunks.h"
+#include "sprites.h"
+#include "text.h"
+#include "snapshot.h"
+#include "pipeline.h"
+#include "level.h"
+#include "random.h"
+#include "profiler.h"
+#include "trace.h"
+#include "timing.h"
+#include "pacing.h"
+#include "memtrack.h"
 
 SDL_Texture* fov_mask = NULL;
 
 int main(int argc, char* argv[]) {
-	srand(time(NULL));
+	bool pipelined = false; // Run the simulation on its own thread
+	bool vsync = false; // Let presenting wait for the display instead of pacing frames to TARGET_FPS
+	Uint64 seed = (Uint64)time(NULL); // Seed for every random stream, fixed with --seed to replay a run
+	const char* trace_path = NULL; // Where to write a trace of the whole run, if --trace was given
+	const char* timing_path = NULL; // Where to write the frame-time percentiles at exit, if anywhere
+	for (int i = 1; i < argc; i++) {
+		if (my_strcmp(argv[i], "--pipeline") == 0) {
+			pipelined = true;
+		} else if (my_strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+			if (!parse_seed(argv[++i], &seed)) {
+				printf("Invalid seed: %s\n", argv[i]);
+				return 1;
+			}
+		} else if (my_strcmp(argv[i], "--trace") == 0) {
+			trace_path = TRACE_DEFAULT_PATH;
+			if (i + 1 < argc && my_strncmp(argv[i + 1], "--", 2) != 0) trace_path = argv[++i];
+		} else if (my_strcmp(argv[i], "--timings") == 0 && i + 1 < argc) {
+			timing_path = argv[++i];
+		} else if (my_strcmp(argv[i], "--vsync") == 0) {
+			vsync = true;
+		} else if (my_strcmp(argv[i], "--max-steps") == 0 && i + 1 < argc) {
+			if (!set_max_sim_steps(atoi(argv[++i]))) {
+				printf("Max steps must be %d-%d\n", MAX_SIM_STEPS_MIN, MAX_SIM_STEPS_MAX);
+				return 1;
+			}
+		}
+	}
+	printf("Seed: %llu\n", (unsigned long long)seed);
 	if (SDL_Init(SDL_INIT_EVERYTHING) < 0) {
 		printf("SDL_Init failed: %s\n", SDL_GetError());
 		return 1;
 	}
+	name_trace_thread("main");
+	mark_stack_base();
+	if (trace_path && !start_trace(trace_path)) printf("Tracing disabled\n");
 	if (IMG_Init(IMG_INIT_PNG) != IMG_INIT_PNG) {
 		printf("IMG_Init failed: %s\n", IMG_GetError());
 		SDL_Quit();
@@ -35,7 +79,7 @@ int main(int argc, char* argv[]) {
 		SDL_Quit();
 		return 1;
 	}
-	SDL_Renderer* renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED);
+	SDL_Renderer* renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED | (vsync ? SDL_RENDERER_PRESENTVSYNC : 0));
 	if (!renderer) {
 		printf("SDL_CreateRenderer failed: %s\n", SDL_GetError());
 		SDL_DestroyWindow(window);
@@ -65,13 +109,13 @@ int main(int argc, char* argv[]) {
 	SDL_Texture* flag_texture = load_texture("assets/images/8x8FlagP.png", renderer);
 	if (!player_texture || !enemy_texture || !grass_texture || !wall_texture_S || !wall_texture_B || !wall_texture_O || !flag_texture) {
 		printf("Failed to load textures\n");
-		SDL_DestroyTexture(player_texture);
-		SDL_DestroyTexture(enemy_texture);
-		SDL_DestroyTexture(grass_texture);
-		SDL_DestroyTexture(wall_texture_S);
-		SDL_DestroyTexture(wall_texture_B);
-		SDL_DestroyTexture(wall_texture_O);
-		SDL_DestroyTexture(flag_texture);
+		destroy_tracked_texture(player_texture);
+		destroy_tracked_texture(enemy_texture);
+		destroy_tracked_texture(grass_texture);
+		destroy_tracked_texture(wall_texture_S);
+		destroy_tracked_texture(wall_texture_B);
+		destroy_tracked_texture(wall_texture_O);
+		destroy_tracked_texture(flag_texture);
 		SDL_DestroyRenderer(renderer);
 		SDL_DestroyWindow(window);
 		TTF_Quit();
@@ -82,18 +126,33 @@ int main(int argc, char* argv[]) {
 
 	GameState game_state = {true, true, true};
 	World world = {0};
-	world.w = WORLD_W;
-	world.h = WORLD_H;
+
+	// Same images as above, packed into one atlas for batched sprite drawing
+	const char* const sprite_paths[SPRITE_COUNT] = {
+		"assets/images/16x16PlayerG.png",
+		"assets/images/16x16PlayerP.png",
+		"assets/images/16x16Grass.png",
+		"assets/images/16x16SWall.png",
+		"assets/images/16x16Wall.png",
+		"assets/images/16x16BWall.png",
+		"assets/images/8x8FlagP.png"
+	};
+	if (!build_sprite_atlas(&world.atlas, renderer, sprite_paths)) {
+		printf("Sprite atlas unavailable, drawing sprites one by one\n");
+	}
+	if (!build_glyph_atlas(&world.glyphs, renderer, font)) {
+		printf("Glyph atlas unavailable, text will not be drawn\n");
+	}
 	world.background = create_background_texture(renderer, grass_texture, WORLD_W, WORLD_H);
 	if (!world.background) {
 		printf("Failed to create background texture\n");
-		SDL_DestroyTexture(fov_mask);
-		SDL_DestroyTexture(player_texture);
-		SDL_DestroyTexture(enemy_texture);
-		SDL_DestroyTexture(grass_texture);
-		SDL_DestroyTexture(wall_texture_S);
-		SDL_DestroyTexture(wall_texture_B);
-		SDL_DestroyTexture(wall_texture_O);
+		destroy_tracked_texture(fov_mask);
+		destroy_tracked_texture(player_texture);
+		destroy_tracked_texture(enemy_texture);
+		destroy_tracked_texture(grass_texture);
+		destroy_tracked_texture(wall_texture_S);
+		destroy_tracked_texture(wall_texture_B);
+		destroy_tracked_texture(wall_texture_O);
 		SDL_DestroyRenderer(renderer);
 		SDL_DestroyWindow(window);
 		TTF_Quit();
@@ -101,88 +160,22 @@ int main(int argc, char* argv[]) {
 		SDL_Quit();
 		return 1;
 	}
-	uint8_t map[MAP_SIZE][MAP_SIZE] = {
-		{0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0},
-		{0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0},
-		{0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0},
-		{0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0},
-		{0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,1,1,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0},
-		{0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,1,1,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0},
-		{0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0},
-		{0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,3,3,0,0,0,0,0,0,0,0,0,0,0,0,0,0},
-		{0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,3,3,0,0,0,0,0,0,0,0,0,0,0,0,0,0},
-		{0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,2,2,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0},
-		{0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,2,2,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0},
-		{0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0},
-		{0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0},
-		{0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0},
-		{0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0},
-		{0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,2,0,0,3,0,2,2,0,0,0,0},
-		{0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,1,0,0,0,0,0,0,0,0,0,0},
-		{0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,1,0,0,0,0,0,0,0,0,0,0},
-		{0,0,0,0,0,0,0,0,0,0,0,0,1,1,1,1,1,1,1,1,1,1,1,1,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,2,0,0,0,0,0,0,0,0,0,0},
-		{0,0,0,0,0,0,0,0,0,0,0,0,2,0,0,0,0,0,0,0,0,0,0,2,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,1,0,0,0,0,0,0,0,0,0,0},
-		{0,0,0,0,0,0,0,0,0,0,0,0,2,0,0,0,0,0,0,0,0,0,0,2,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,1,0,0,0,0,0,0,0,0,0,0},
-		{0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,2,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,1,0,0,0,0,0,0,0,0,0,0},
-		{0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,1,0,0,0,0,0,0,0,0,0,0},
-		{0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,2,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,1,0,0,0,0,0,0,0,0,0,0},
-		{0,0,0,0,0,0,0,0,0,0,0,0,2,0,0,0,0,0,0,0,0,0,0,2,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,1,0,0,0,0,0,0,0,0,0,0},
-		{0,0,0,0,0,0,0,0,0,0,0,0,2,0,0,0,0,0,0,0,0,0,0,2,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,1,0,0,0,0,0,0,0,0,0,0},
-		{0,0,0,0,0,0,0,0,0,0,0,0,3,3,3,3,3,3,3,3,3,3,3,3,0,0,2,2,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,1,0,0,0,0,0,0,0,0,0,0},
-		{0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,2,2,0,0,0,0,0,0,0,1,1,1,1,1,1,1,1,1,1,1,0,0,0,0,0,0,0,1,0,0,0,0,0,0,0,0,0,0},
-		{0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,1,3,0,0,0,0,0,0,0,0,0,0,0,3,0,0,0,0,0,0,1,0,0,0,0,0,0,0,0,0,0},
-		{0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,1,3,0,0,0,0,0,0,0,0,0,0,0,3,0,0,0,0,0,0,1,0,0,0,0,0,0,0,0,0,0},
-		{0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,1,3,0,0,0,0,0,0,0,0,0,0,0,3,0,0,0,0,0,0,2,0,0,0,0,0,0,0,0,0,0},
-		{0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,1,3,0,0,0,0,0,0,0,0,0,0,0,3,0,0,0,0,0,0,1,0,0,0,0,0,0,0,0,0,0},
-		{0,0,0,0,0,0,0,0,1,1,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,1,3,0,0,0,0,0,0,0,0,0,0,0,3,0,0,0,0,0,0,1,0,0,0,0,0,0,0,0,0,0},
-		{0,0,0,0,0,0,0,0,1,1,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,1,3,0,0,0,0,0,0,0,0,0,0,0,3,0,0,0,0,0,0,2,1,1,2,1,1,2,1,1,2,1},
-		{0,0,0,0,0,0,0,0,0,0,1,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,1,3,0,0,0,0,0,0,0,0,0,0,0,3,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0},
-		{0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,3,3,0,0,0,0,0,0,1,3,0,0,0,0,0,0,0,0,0,0,0,3,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0},
-		{0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,3,3,0,0,0,0,0,0,1,3,0,0,0,0,0,0,0,0,0,0,0,3,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0},
-		{0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,1,3,0,0,0,0,0,0,0,0,0,0,0,3,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0},
-		{0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,1,3,0,0,0,0,0,0,0,0,0,0,0,3,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0},
-		{0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,1,1,0,0,0,0,0,0,0,0,0,0,0,1,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0},
-		{0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,1,1,1,1,1,1,1,1,1,1,1,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0},
-		{0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0},
-		{0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0},
-		{0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0},
-		{0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,1,1,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0},
-		{0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,1,1,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0},
-		{0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0},
-		{0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,3,3,0,0,0,0,0,0,0,0,0,0,0,0,0,0},
-		{0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,3,3,0,0,0,0,0,0,0,0,0,0,0,0,0,0},
-		{0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,2,2,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0},
-		{0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,2,2,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0},
-		{0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0},
-		{0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0},
-		{0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0},
-		{0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0},
-		{0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,2,0,0,3,0,2,2,0,0,0,0},
-		{0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,1,0,0,0,0,0,0,0,0,0,0},
-		{0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,1,0,0,0,0,0,0,0,0,0,0},
-		{0,0,0,0,0,0,0,0,0,0,0,0,1,1,1,1,1,1,1,1,1,1,1,1,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,2,0,0,0,0,0,0,0,0,0,0},
-		{0,0,0,0,0,0,0,0,0,0,0,0,2,0,0,0,0,0,0,0,0,0,0,2,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,1,0,0,0,0,0,0,0,0,0,0},
-		{0,0,0,0,0,0,0,0,0,0,0,0,2,0,0,0,0,0,0,0,0,0,0,2,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,1,0,0,0,0,0,0,0,0,0,0},
-		{0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,2,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,1,0,0,0,0,0,0,0,0,0,0},
-		{0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,1,0,0,0,0,0,0,0,0,0,0},
-		{0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,2,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,1,0,0,0,0,0,0,0,0,0,0},
-	};
-	memcpy(world.map, map, sizeof(map));
+	load_level_map(&world);
 	init_walls(&world, renderer, wall_texture_S, wall_texture_B, wall_texture_O);
+	build_cover_index(&world);
+	init_influence_map(&world);
+	init_map_chunks(&world, renderer);
 
-	world.flag_count = 2; // Example: 2 flags
-	world.flags = malloc(sizeof(Flag) * world.flag_count);
-	if (!world.flags) {
-		printf("Failed to allocate flags\n");
-		SDL_DestroyTexture(fov_mask);
-		SDL_DestroyTexture(player_texture);
-		SDL_DestroyTexture(enemy_texture);
-		SDL_DestroyTexture(grass_texture);
-		SDL_DestroyTexture(wall_texture_S);
-		SDL_DestroyTexture(wall_texture_B);
-		SDL_DestroyTexture(wall_texture_O);
-		SDL_DestroyTexture(flag_texture);
-		SDL_DestroyTexture(world.background);
+	if (!init_flags(&world, 5, flag_texture)) { // Default 5 enemies per flag
+		destroy_tracked_texture(fov_mask);
+		destroy_tracked_texture(player_texture);
+		destroy_tracked_texture(enemy_texture);
+		destroy_tracked_texture(grass_texture);
+		destroy_tracked_texture(wall_texture_S);
+		destroy_tracked_texture(wall_texture_B);
+		destroy_tracked_texture(wall_texture_O);
+		destroy_tracked_texture(flag_texture);
+		destroy_tracked_texture(world.background);
 		SDL_DestroyRenderer(renderer);
 		SDL_DestroyWindow(window);
 		TTF_Quit();
@@ -190,19 +183,8 @@ int main(int argc, char* argv[]) {
 		SDL_Quit();
 		return 1;
 	}
-	for (int i = 0; i < world.flag_count; i++) {
-		world.flags[i].x = (MAP_SIZE / 4 + (i * MAP_SIZE / 2)) * TILE_SIZE;
-		world.flags[i].y = (MAP_SIZE / 4) * TILE_SIZE;
-		world.flags[i].w = 24;
-		world.flags[i].h = 24;
-		world.flags[i].texture = flag_texture;
-		world.flags[i].active = true;
-		world.flags[i].enemy_count = 5; // Default 5 enemies per flag
-		world.flags[i].spawn_timer = 0.0f;
-		world.flags[i].enemies_spawned = 0;
-	}
 
-	Player player = {WORLD_W / 2, WORLD_H / 2, 48, 48, 0, 0, 0, player_texture};
+	Player player = {WORLD_W / 2, WORLD_H / 2, 48, 48, 0, 0, 0, player_texture, WORLD_W / 2, WORLD_H / 2, 0};
 	Camera camera = {WORLD_W / 2 - CAMERA_W / 2, WORLD_H / 2 - CAMERA_H / 2, CAMERA_W, CAMERA_H};
 	Bullet bullets[MAX_BULLETS] = {0};
 	Enemy enemies[MAX_ENEMIES] = {0};
@@ -212,52 +194,50 @@ int main(int argc, char* argv[]) {
 		enemies[i].texture = enemy_texture;
 		enemies[i].flag_id = -1;
 	}
+	seed_enemy_random(enemies, seed);
 
 	// Initial enemy spawn around flags
 	if (game_state.spawn_enabled) {
-		int total_enemies_spawned = 0;
-		for (int i = 0; i < world.flag_count && total_enemies_spawned < MAX_ENEMIES; i++) {
-			if (!world.flags[i].active) continue;
-			for (int j = 0; j < world.flags[i].enemy_count && total_enemies_spawned < MAX_ENEMIES; j++) {
-				for (int k = 0; k < MAX_ENEMIES; k++) {
-					if (!enemies[k].active) {
-						spawn_enemy(&enemies[k], &world, &camera, i);
-						world.flags[i].enemies_spawned++;
-						total_enemies_spawned++;
-						break;
-					}
-				}
-			}
-			if (total_enemies_spawned >= MAX_ENEMIES) {
-				char msg[MAX_COMMAND_LENGTH];
-				snprintf(msg, MAX_COMMAND_LENGTH, "Warning: MAX_ENEMIES (%d) reached, some enemies not spawned", MAX_ENEMIES);
-				printf("%s\n", msg);
-				// Log to console
-				Console temp_console = {0};
-				init_console(&temp_console, renderer, font);
-				my_strcpy(temp_console.text[temp_console.current_line], msg);
-				temp_console.timestamps[temp_console.current_line] = MESSAGE_DURATION;
-				temp_console.current_line = (temp_console.current_line + 1) % MAX_CONSOLE_LINES;
-				temp_console.line_count = temp_console.line_count < MAX_CONSOLE_LINES ? temp_console.line_count + 1 : MAX_CONSOLE_LINES;
-			}
-		}
+		spawn_flag_enemies(&world, enemies, &camera);
 	}
 
-	init_console(&console, renderer, font);
-	init_menu(&menu, renderer, font, &game_state);
+	init_console(&console);
+	init_menu(&menu, renderer, &world.glyphs, &game_state);
 	SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
 	SDL_SetWindowFullscreen(window, game_state.is_fullscreen ? SDL_WINDOW_FULLSCREEN_DESKTOP : 0);
 	SDL_StartTextInput();
 
+	// Rendering only ever draws snapshots. The first is built here so there is one before the first tick.
+	static SnapshotBuffer snapshots;
+	init_snapshot_buffer(&snapshots);
+	publish_render_snapshot(&snapshots, &player, &world, enemies, bullets);
+	static SimPipeline pipeline;
+	if (pipelined && !start_sim_pipeline(&pipeline, &player, &world, enemies, bullets, &game_state, &snapshots)) {
+		printf("Running the simulation on the main thread\n");
+	}
+
 	bool running = true;
 	double frame_times[10] = {0.0};
 	int frame_time_index = 0;
 	world.fps = 0.0f;  // Initialize fps in world
 	float fps_update_timer = 0.0f;
 	double accumulator = 0.0;
+	// Player input is read here each frame and handed to the simulation, wherever it runs.
+	// Clicks are latched so a frame without a tick doesn't drop the shot.
+	PlayerInput input = {0};
+	bool fire_pending = false;
+	Player player_view = player;
 
 	const Uint64 frequency = SDL_GetPerformanceFrequency();
 	Uint64 last_time = SDL_GetPerformanceCounter();
+	FramePacer pacer;
+	// Drivers can turn a vsync request down; only leave pacing to presenting if it was granted
+	SDL_RendererInfo renderer_info;
+	if (vsync && (SDL_GetRendererInfo(renderer, &renderer_info) < 0 || !(renderer_info.flags & SDL_RENDERER_PRESENTVSYNC))) {
+		printf("Vsync unavailable, pacing frames instead\n");
+		vsync = false;
+	}
+	init_frame_pacer(&pacer, TARGET_FPS, vsync);
 
 	while (running) {
 		Uint64 frame_start = SDL_GetPerformanceCounter();
@@ -266,11 +246,16 @@ int main(int argc, char* argv[]) {
 		while (SDL_PollEvent(&event)) {
 			if (event.type == SDL_QUIT) {
 				running = false;
+			} else if (event.type == SDL_RENDER_TARGETS_RESET || event.type == SDL_RENDER_DEVICE_RESET) {
+				invalidate_fov_mask();
+				invalidate_map_chunks(&world);
 			} else if (event.type == SDL_KEYDOWN) {
 				SDL_Keycode key = event.key.keysym.sym;
 				if (console.active) {
 					// Only handle console-related keys when console is active
+					lock_simulation(&pipeline);
 					handle_console_input(&console, &player, &world, &event);
+					unlock_simulation(&pipeline);
 				} else{
 					// Handle game controls only when console is inactive
 					switch (key) {
@@ -282,21 +267,29 @@ int main(int argc, char* argv[]) {
 								menu.main_options[i].is_hovered = false;
 							}
 							break;
+						case SDLK_F3:
+							toggle_profiler_overlay();
+							break;
 						case SDLK_RETURN:
+							lock_simulation(&pipeline);
 							handle_console_input(&console, &player, &world, &event);
+							unlock_simulation(&pipeline);
 							break;
 						default:
 							break;
 					}
 				}
 			} else if (event.type == SDL_TEXTINPUT && console.active) {
+				lock_simulation(&pipeline);
 				handle_console_input(&console, &player, &world, &event);
+				unlock_simulation(&pipeline);
 			} else if (event.type == SDL_MOUSEBUTTONDOWN && event.button.button == SDL_BUTTON_LEFT && !console.active && !menu.active) {
-				Entity player_entity = {player.x, player.y, player.w, player.h, player.angle, {0}, 0};
-				spawn_bullet(bullets, &player_entity, 1);
+				fire_pending = true;
 			}
 			if(menu.active){
+				lock_simulation(&pipeline);
 				handle_menu_input(&menu, &event, &running, window);
+				unlock_simulation(&pipeline);
 			}
 		}
 
@@ -304,29 +297,66 @@ int main(int argc, char* argv[]) {
 		double delta_time = (double)(current_time - last_time) / frequency;
 		last_time = current_time;
 
-		if(!menu.active){
-			accumulator += delta_time;
-			while (accumulator >= FIXED_DT) {
-				fixed_update_player(&player, &world, bullets, &camera, &console);
-				fixed_update_enemies(&player, &world, bullets, enemies, &camera, &game_state);
-				accumulator -= FIXED_DT;
-			}
+		// Aim from the camera and player as last drawn, which is what the mouse points at
+		if (!console.active && !menu.active) {
+			read_player_input(&input, &camera, &player_view);
+		} else {
+			input = (PlayerInput){0};
 		}
+		input.fire = fire_pending;
 
-		update_camera(&camera, &player, &world, renderer);
-		render(renderer, &player, &camera, &world, bullets, enemies, font, &console, &game_state, &menu);
-
-		// Frame rate capping
-		Uint64 work_end_time = SDL_GetPerformanceCounter();
-		double work_time_ms = (double)(work_end_time - frame_start) / frequency * 1000.0;
-		if (work_time_ms < TARGET_FRAME_TIME) {
-			SDL_Delay((Uint32)(TARGET_FRAME_TIME - work_time_ms));
+		// Draw everything the remaining fraction of a tick between its last two fixed updates,
+		// so motion stays smooth whatever the simulation rate
+		const RenderSnapshot* snap;
+		float alpha;
+		if (pipeline.thread) {
+			SDL_AtomicSet(&pipeline.paused, menu.active);
+			lock_simulation(&pipeline);
+			input.fire = input.fire || pipeline.input.fire; // Still waiting for a tick
+			pipeline.input = input;
+			unlock_simulation(&pipeline);
+			fire_pending = false;
+			snap = acquire_render_snapshot(&snapshots);
+			alpha = (float)((double)(SDL_GetPerformanceCounter() - snap->time) / frequency / snap->dt);
+		} else {
+			if(!menu.active){
+				accumulator += delta_time;
+				limit_sim_steps(&accumulator, fixed_dt);
+				bool ticked = accumulator >= fixed_dt;
+				while (accumulator >= fixed_dt) {
+					Uint64 tick_start = SDL_GetPerformanceCounter();
+					TRACE_BEGIN(tick);
+					save_previous_transforms(&player, enemies, bullets);
+					apply_player_input(&player, &world, bullets, &input);
+					input.fire = fire_pending = false;
+					fixed_update_enemies(&player, &world, bullets, enemies, &camera, &game_state);
+					accumulator -= fixed_dt;
+					TRACE_END(tick, "tick", 0);
+					record_timing(TIMING_TICK, tick_start, SDL_GetPerformanceCounter());
+				}
+				if (ticked) publish_render_snapshot(&snapshots, &player, &world, enemies, bullets);
+			}
+			snap = acquire_render_snapshot(&snapshots);
+			alpha = (float)(accumulator / fixed_dt);
 		}
+		alpha = minf(maxf(alpha, 0.0f), 1.0f);
+		player_view = interpolate_player(&snap->player, alpha);
+		update_camera(&camera, &player_view, &world, renderer);
+		SDL_AtomicSet(&pipeline.view_w, camera.w);
+		SDL_AtomicSet(&pipeline.view_h, camera.h);
+		Uint64 render_start = SDL_GetPerformanceCounter();
+		render(renderer, snap, &player_view, alpha, (float)delta_time, &camera, &world, &console, &game_state, &menu);
+		record_timing(TIMING_RENDER, render_start, SDL_GetPerformanceCounter());
+		profile_end_frame();
+		end_memory_frame();
+
+		pace_frame(&pacer);
 
 		// Measure full frame time including delay
 		Uint64 end_time = SDL_GetPerformanceCounter();
 		double frame_time_sec = (double)(end_time - frame_start) / frequency;
 		if (frame_time_sec < 0.0) frame_time_sec = 0.0;  // Safeguard against anomalies
+		record_timing(TIMING_FRAME, frame_start, end_time);
 
 		// Update FPS calculation
 		fps_update_timer += (float)delta_time;
@@ -343,19 +373,28 @@ int main(int argc, char* argv[]) {
 		}
 	}
 
-	free_console(&console);
-	free_menu(&menu);
-	for (int i = 0; i < world.wall_count; i++) SDL_DestroyTexture(world.walls[i].texture);
-	free(world.walls);
-	SDL_DestroyTexture(player_texture);
-	SDL_DestroyTexture(enemy_texture);
-	SDL_DestroyTexture(grass_texture);
-	SDL_DestroyTexture(wall_texture_S);
-	SDL_DestroyTexture(wall_texture_B);
-	SDL_DestroyTexture(wall_texture_O);
-	SDL_DestroyTexture(flag_texture);
-	SDL_DestroyTexture(world.background);
-	SDL_DestroyTexture(fov_mask);
+	stop_sim_pipeline(&pipeline);
+	if (is_tracing() && !stop_trace(NULL)) stop_trace(TRACE_DEFAULT_PATH); // Last try, so the trace isn't lost
+	print_timing_report();
+	if (timing_path && write_timing_report(timing_path)) printf("Wrote timings to %s\n", timing_path);
+	my_free(world.walls); // Walls share the wall textures, destroyed once each below
+	my_free(world.flags);
+	free_cover_index(&world);
+	free_influence_map(&world);
+	free_map_chunks(&world);
+	free_sprite_atlas(&world.atlas);
+	free_glyph_atlas(&world.glyphs);
+	destroy_tracked_texture(world.minimap_texture);
+	destroy_tracked_texture(player_texture);
+	destroy_tracked_texture(enemy_texture);
+	destroy_tracked_texture(grass_texture);
+	destroy_tracked_texture(wall_texture_S);
+	destroy_tracked_texture(wall_texture_B);
+	destroy_tracked_texture(wall_texture_O);
+	destroy_tracked_texture(flag_texture);
+	destroy_tracked_texture(world.background);
+	destroy_tracked_texture(fov_mask);
+	print_memory_report(); // After the frees, so anything still live is a leak; peaks cover the whole run
 	TTF_CloseFont(font);
 	SDL_DestroyRenderer(renderer);
 	SDL_DestroyWindow(window);
@@ -0,0 +1,226 @@
+#include "memtrack.h"
+#include <stddef.h>
+
+static const char* stack_site_names[STACK_SITE_COUNT] = {
+    [STACK_TICK] = "enemy tick",
+    [STACK_FIND_PATH] = "find_path",
+    [STACK_FIND_COVER] = "find_cover",
+    [STACK_RENDER] = "render"
+};
+
+// Sits in front of every block my_malloc hands out, recording its size for my_free. The union
+// keeps the block after it aligned for any type.
+typedef union {
+    size_t size;
+    max_align_t align;
+} AllocHeader;
+
+// Heap figures change on any thread (the simulation thread rebuilds cover points, say), so they
+// are kept under a lock. Textures are only made and destroyed on the main thread.
+static SDL_SpinLock heap_lock;
+static MemoryStats stats;
+static int frame_allocs = 0, frame_frees = 0; // So far this frame
+static int frame_textures_created = 0, frame_textures_destroyed = 0;
+
+static struct {
+    SDL_Texture* texture;
+    const char* name;  // What the texture is for; a string literal, not copied
+    Uint64 bytes;      // Estimated size
+} textures[MEMORY_MAX_TEXTURES];
+
+static SDL_atomic_t stack_peak[STACK_SITE_COUNT];
+static SDL_TLSID stack_base_tls = 0;
+
+static void count_alloc(size_t size) {
+    SDL_AtomicLock(&heap_lock);
+    stats.allocs++;
+    stats.heap_bytes += size;
+    if (stats.heap_bytes > stats.heap_peak_bytes) stats.heap_peak_bytes = stats.heap_bytes;
+    frame_allocs++;
+    SDL_AtomicUnlock(&heap_lock);
+}
+
+static void count_free(size_t size) {
+    SDL_AtomicLock(&heap_lock);
+    stats.frees++;
+    stats.heap_bytes -= size;
+    frame_frees++;
+    SDL_AtomicUnlock(&heap_lock);
+}
+
+// Counting malloc for project code. Whatever it returns must be released with my_free or
+// my_realloc, never free.
+void* my_malloc(size_t size) {
+    AllocHeader* header = malloc(sizeof(AllocHeader) + size);
+    if (!header) return NULL;
+    header->size = size;
+    count_alloc(size);
+    return header + 1;
+}
+
+void* my_calloc(size_t count, size_t size) {
+    if (size && count > (SIZE_MAX - sizeof(AllocHeader)) / size) return NULL;
+    AllocHeader* header = calloc(1, sizeof(AllocHeader) + count * size);
+    if (!header) return NULL;
+    header->size = count * size;
+    count_alloc(count * size);
+    return header + 1;
+}
+
+// Counts a resize as freeing the old block and allocating the new one
+void* my_realloc(void* ptr, size_t size) {
+    if (!ptr) return my_malloc(size);
+    if (size == 0) {
+        my_free(ptr);
+        return NULL;
+    }
+    AllocHeader* header = (AllocHeader*)ptr - 1;
+    size_t old_size = header->size;
+    AllocHeader* resized = realloc(header, sizeof(AllocHeader) + size);
+    if (!resized) return NULL;
+    resized->size = size;
+    count_free(old_size);
+    count_alloc(size);
+    return resized + 1;
+}
+
+void my_free(void* ptr) {
+    if (!ptr) return;
+    AllocHeader* header = (AllocHeader*)ptr - 1;
+    count_free(header->size);
+    free(header);
+}
+
+// Estimates a texture's memory from its size and pixel format, and adds it to the registry
+static void register_texture(SDL_Texture* texture, const char* name) {
+    Uint32 format;
+    int w, h;
+    if (SDL_QueryTexture(texture, &format, NULL, &w, &h) < 0) return;
+    int slot = 0;
+    while (slot < MEMORY_MAX_TEXTURES && textures[slot].texture) slot++;
+    if (slot == MEMORY_MAX_TEXTURES) {
+        stats.untracked_textures++;
+        return;
+    }
+    Uint64 bytes = (Uint64)w * h * SDL_BYTESPERPIXEL(format);
+    textures[slot].texture = texture;
+    textures[slot].name = name;
+    textures[slot].bytes = bytes;
+    stats.textures++;
+    stats.texture_bytes += bytes;
+    if (stats.texture_bytes > stats.texture_peak_bytes) stats.texture_peak_bytes = stats.texture_bytes;
+    stats.textures_created++;
+    frame_textures_created++;
+}
+
+// SDL_CreateTexture, with the texture counted under name until destroy_tracked_texture
+SDL_Texture* create_tracked_texture(SDL_Renderer* renderer, Uint32 format, int access, int w, int h, const char* name) {
+    SDL_Texture* texture = SDL_CreateTexture(renderer, format, access, w, h);
+    if (texture) register_texture(texture, name);
+    return texture;
+}
+
+// SDL_CreateTextureFromSurface, with the texture counted under name until destroy_tracked_texture
+SDL_Texture* create_tracked_texture_from_surface(SDL_Renderer* renderer, SDL_Surface* surface, const char* name) {
+    SDL_Texture* texture = SDL_CreateTextureFromSurface(renderer, surface);
+    if (texture) register_texture(texture, name);
+    return texture;
+}
+
+// SDL_DestroyTexture, taking the texture out of the registry. Untracked textures and NULL are
+// destroyed as SDL_DestroyTexture would.
+void destroy_tracked_texture(SDL_Texture* texture) {
+    if (!texture) return;
+    for (int i = 0; i < MEMORY_MAX_TEXTURES; i++) {
+        if (textures[i].texture != texture) continue;
+        stats.textures--;
+        stats.texture_bytes -= textures[i].bytes;
+        stats.textures_destroyed++;
+        frame_textures_destroyed++;
+        textures[i].texture = NULL;
+        break;
+    }
+    SDL_DestroyTexture(texture);
+}
+
+// Records the calling thread's stack position as the base note_stack_depth measures from.
+// Call it at the top of each thread's entry function.
+void mark_stack_base(void) {
+    volatile char marker = 0;
+    if (!stack_base_tls) stack_base_tls = SDL_TLSCreate();
+    SDL_TLSSet(stack_base_tls, (void*)&marker, NULL);
+}
+
+// Records how far the stack has grown below the thread's base at the caller. Being a call into
+// another file, it can't be inlined, so its own frame lies below all of the caller's locals and
+// the depth covers the caller's whole frame. Does nothing on threads that never marked a base.
+void note_stack_depth(StackSite site) {
+    volatile char marker = 0;
+    const char* base = stack_base_tls ? SDL_TLSGet(stack_base_tls) : NULL;
+    if (!base) return;
+    ptrdiff_t depth = base - (const char*)&marker;
+    if (depth < 0) depth = -depth; // Stacks that grow upwards
+    int peak;
+    do {
+        peak = SDL_AtomicGet(&stack_peak[site]);
+        if (depth <= peak) return;
+    } while (!SDL_AtomicCAS(&stack_peak[site], peak, (int)depth));
+}
+
+// Closes the current frame's allocation and texture counts, which get_memory_stats then reports
+void end_memory_frame(void) {
+    SDL_AtomicLock(&heap_lock);
+    stats.frame_allocs = frame_allocs;
+    stats.frame_frees = frame_frees;
+    frame_allocs = frame_frees = 0;
+    SDL_AtomicUnlock(&heap_lock);
+    stats.frame_textures_created = frame_textures_created;
+    stats.frame_textures_destroyed = frame_textures_destroyed;
+    frame_textures_created = frame_textures_destroyed = 0;
+}
+
+void get_memory_stats(MemoryStats* out) {
+    SDL_AtomicLock(&heap_lock);
+    *out = stats;
+    SDL_AtomicUnlock(&heap_lock);
+    for (int i = 0; i < STACK_SITE_COUNT; i++) out->stack_peak[i] = SDL_AtomicGet(&stack_peak[i]);
+}
+
+const char* get_stack_site_name(StackSite site) {
+    return stack_site_names[site];
+}
+
+// Prints the tracked heap and textures, the live textures by name, stack peaks, and the size
+// of the large fixed tables for comparison
+void print_memory_report(void) {
+    MemoryStats s;
+    get_memory_stats(&s);
+    printf("heap: %llu live allocations, %.1f KB live, %.1f KB peak, %llu allocs and %llu frees in total, %d/%d last frame\n",
+           (unsigned long long)(s.allocs - s.frees), s.heap_bytes / 1024.0, s.heap_peak_bytes / 1024.0,
+           (unsigned long long)s.allocs, (unsigned long long)s.frees, s.frame_allocs, s.frame_frees);
+    printf("textures: %d live, about %.1f KB, %.1f KB peak, %llu created and %llu destroyed in total, %d/%d last frame\n",
+           s.textures, s.texture_bytes / 1024.0, s.texture_peak_bytes / 1024.0, (unsigned long long)s.textures_created,
+           (unsigned long long)s.textures_destroyed, s.frame_textures_created, s.frame_textures_destroyed);
+    if (s.untracked_textures) printf("  %d textures not tracked, registry full\n", s.untracked_textures);
+    // One line per name, summed over the live textures with that name
+    for (int i = 0; i < MEMORY_MAX_TEXTURES; i++) {
+        if (!textures[i].texture) continue;
+        bool seen = false;
+        for (int j = 0; j < i && !seen; j++) seen = textures[j].texture && textures[j].name == textures[i].name;
+        if (seen) continue;
+        int count = 0;
+        Uint64 bytes = 0;
+        for (int j = i; j < MEMORY_MAX_TEXTURES; j++) {
+            if (!textures[j].texture || textures[j].name != textures[i].name) continue;
+            count++;
+            bytes += textures[j].bytes;
+        }
+        printf("  %-14s %4d  %10.1f KB\n", textures[i].name, count, bytes / 1024.0);
+    }
+    printf("stack peaks:");
+    for (int i = 0; i < STACK_SITE_COUNT; i++) printf("  %s %.1f KB", stack_site_names[i], s.stack_peak[i] / 1024.0);
+    printf("\n");
+    printf("fixed tables: enemies %.1f KB, bullets %.1f KB, world %.1f KB, snapshots %.1f KB\n",
+           sizeof(Enemy) * MAX_ENEMIES / 1024.0, sizeof(Bullet) * MAX_BULLETS / 1024.0, sizeof(World) / 1024.0,
+           sizeof(SnapshotBuffer) / 1024.0);
+}
@@ -1,16 +1,17 @@
 #include "menu.h"
 #include "utils.h"
+#include "text.h"
 
-void init_menu(Menu* menu, SDL_Renderer* renderer, TTF_Font* font, GameState* game_state) {
-	if (!renderer || !font || !game_state) {
-		printf("Error: Null renderer, font, or game_state in init_menu\n");
+void init_menu(Menu* menu, SDL_Renderer* renderer, GlyphAtlas* glyphs, GameState* game_state) {
+	if (!renderer || !glyphs || !game_state) {
+		printf("Error: Null renderer, glyphs, or game_state in init_menu\n");
 		return;
 	}
 	menu->active = false;
 	menu->type = MAIN_MENU;
 	menu->selected_option = -1;
 	menu->game_state = game_state;
-	menu->font = font;
+	menu->glyphs = glyphs;
 
 	// Initialize Main Menu
 	const char* main_option_texts[MENU_OPTION_COUNT] = {"Resume", "Options", "Quit", ""};
@@ -38,23 +39,6 @@ void init_menu(Menu* menu, SDL_Renderer* renderer, TTF_Font* font, GameState* ga
 		opt->rect.w = menu_width;
 		opt->rect.h = i < 3 ? option_height : 0; // Zero height for unused
 		opt->is_hovered = false;
-
-		if (opt->text[0]) {
-			SDL_Color text_color = {255, 255, 255, 255};
-			SDL_Surface* surface = TTF_RenderText_Solid(font, opt->text, text_color);
-			if (!surface) {
-				printf("Failed to render main menu text '%s': %s\n", opt->text, TTF_GetError());
-				opt->text_texture = NULL;
-				continue;
-			}
-			opt->text_texture = SDL_CreateTextureFromSurface(renderer, surface);
-			SDL_FreeSurface(surface);
-			if (!opt->text_texture) {
-				printf("Failed to create main menu text texture for '%s': %s\n", opt->text, SDL_GetError());
-			}
-		} else {
-			opt->text_texture = NULL;
-		}
 	}
 
 	// Initialize Options Menu
@@ -67,7 +51,7 @@ void init_menu(Menu* menu, SDL_Renderer* renderer, TTF_Font* font, GameState* ga
 		opt->rect.w = menu_width;
 		opt->rect.h = option_height;
 		opt->is_hovered = false;
-		opt->text_texture = NULL; // Created dynamically
+		opt->text[0] = '\0'; // Filled in by render_menu
 	}
 }
 
@@ -134,7 +118,7 @@ void handle_menu_input(Menu* menu, SDL_Event* event, bool* running, SDL_Window*
 
 void render_menu(SDL_Renderer* renderer, Menu* menu) {
     if (!menu->active) return;
-    if (!renderer || !menu->font) return;
+    if (!renderer || !menu->glyphs) return;
 
     // Get current renderer size
     int renderer_w, renderer_h;
@@ -161,7 +145,7 @@ void render_menu(SDL_Renderer* renderer, Menu* menu) {
         opt->rect.h = option_height;
     }
 
-    // Update Options menu text textures
+    // Update Options menu labels
     if (menu->type == OPTIONS_MENU) {
         const char* option_texts[MENU_OPTION_COUNT] = {
             menu->game_state->minimap ? "Minimap: On" : "Minimap: Off",
@@ -170,28 +154,13 @@ void render_menu(SDL_Renderer* renderer, Menu* menu) {
             "Back"
         };
         for (int i = 0; i < MENU_OPTION_COUNT; i++) {
-            MenuOption* opt = &menu->options_menu_options[i];
-            if (my_strcmp(opt->text, option_texts[i]) != 0) {
-                my_strcpy(opt->text, option_texts[i]);
-                if (opt->text_texture) {
-                    SDL_DestroyTexture(opt->text_texture);
-                    opt->text_texture = NULL;
-                }
-                SDL_Color text_color = {255, 255, 255, 255};
-                SDL_Surface* surface = TTF_RenderText_Solid(menu->font, opt->text, text_color);
-                if (surface) {
-                    opt->text_texture = SDL_CreateTextureFromSurface(renderer, surface);
-                    SDL_FreeSurface(surface);
-                    if (!opt->text_texture) {
-                        printf("Failed to create options menu text texture for '%s': %s\n", opt->text, SDL_GetError());
-                    }
-                } else {
-                    printf("Failed to render options menu text '%s': %s\n", opt->text, TTF_GetError());
-                }
-            }
+            my_strcpy(menu->options_menu_options[i].text, option_texts[i]);
         }
     }
 
+    // Boxes first, then every label in one text batch on top
+    static TextBatch batch;
+    begin_text_batch(&batch, renderer, menu->glyphs);
     SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
     for (int i = 0; i < count; i++) {
         MenuOption* opt = &options[i];
@@ -206,33 +175,13 @@ void render_menu(SDL_Renderer* renderer, Menu* menu) {
         SDL_RenderDrawRect(renderer, &opt->rect);
 
         // Text
-        if (opt->text_texture) {
-            int text_w, text_h;
-            if (SDL_QueryTexture(opt->text_texture, NULL, NULL, &text_w, &text_h) == 0) {
-                SDL_Rect text_rect = {
-                    opt->rect.x + (opt->rect.w - text_w) / 2,
-                    opt->rect.y + (opt->rect.h - text_h) / 2,
-                    text_w,
-                    text_h
-                };
-                SDL_SetTextureColorMod(opt->text_texture, opt->is_hovered ? 0 : 255, opt->is_hovered ? 0 : 255, opt->is_hovered ? 0 : 255);
-                SDL_RenderCopy(renderer, opt->text_texture, NULL, &text_rect);
-            } else {
-                printf("Failed to query texture for '%s': %s\n", opt->text, SDL_GetError());
-            }
+        if (opt->text[0]) {
+            int text_w = measure_text(menu->glyphs, opt->text);
+            int text_h = menu->glyphs->line_height;
+            Uint8 shade = opt->is_hovered ? 0 : 255;
+            SDL_Color text_color = {shade, shade, shade, 255};
+            add_text(&batch, opt->text, opt->rect.x + (opt->rect.w - text_w) / 2, opt->rect.y + (opt->rect.h - text_h) / 2, text_color);
         }
     }
-}
-
-void free_menu(Menu* menu) {
-	for (int i = 0; i < MENU_OPTION_COUNT; i++) {
-		if (menu->main_options[i].text_texture) {
-			SDL_DestroyTexture(menu->main_options[i].text_texture);
-			menu->main_options[i].text_texture = NULL;
-		}
-		if (menu->options_menu_options[i].text_texture) {
-			SDL_DestroyTexture(menu->options_menu_options[i].text_texture);
-			menu->options_menu_options[i].text_texture = NULL;
-		}
-	}
+    flush_text_batch(&batch);
 }
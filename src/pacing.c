@@ -0,0 +1,83 @@
+#include "pacing.h"
+#include "profiler.h"
+
+int max_sim_steps = MAX_SIM_STEPS_DEFAULT;
+
+// Waits until the performance counter reaches deadline. SDL_Delay alone can oversleep by a
+// scheduler quantum, so it only covers the wait up to PACING_SPIN_MS before the deadline and
+// the rest is spun out.
+static void wait_until(Uint64 deadline) {
+    const Uint64 frequency = SDL_GetPerformanceFrequency();
+    const Uint64 margin = (Uint64)(PACING_SPIN_MS * frequency / 1000.0);
+    Uint64 now = SDL_GetPerformanceCounter();
+    if (now >= deadline) return;
+    if (deadline - now > margin) {
+        SDL_Delay((Uint32)((deadline - now - margin) * 1000 / frequency));
+    }
+    while (SDL_GetPerformanceCounter() < deadline) {}
+}
+
+void init_frame_pacer(FramePacer* pacer, float fps, bool vsync) {
+    pacer->period = (Uint64)(SDL_GetPerformanceFrequency() / fps);
+    pacer->deadline = SDL_GetPerformanceCounter() + pacer->period;
+    pacer->vsync = vsync;
+    pacer->last_present = 0;
+    pacer->fast_frames = 0;
+}
+
+// Returns true once PACING_VSYNC_FAST_FRAMES frames in a row came in faster than any display
+// refreshes, meaning presenting doesn't actually wait for vsync
+static bool vsync_is_ignored(FramePacer* pacer, Uint64 now) {
+    const Uint64 min_frame = (Uint64)(PACING_VSYNC_MIN_MS * SDL_GetPerformanceFrequency() / 1000.0);
+    bool fast = pacer->last_present && now - pacer->last_present < min_frame;
+    pacer->last_present = now;
+    pacer->fast_frames = fast ? pacer->fast_frames + 1 : 0;
+    return pacer->fast_frames >= PACING_VSYNC_FAST_FRAMES;
+}
+
+// Ends the frame on its deadline and sets the next one a period later, so frames keep a steady
+// cadence rather than each starting a full period after the last one's work ended. A frame that
+// overruns by more than a period moves the deadlines on instead of trying to catch up.
+// With vsync presenting already waited for the display, unless the driver turns out to ignore
+// it, in which case the pacer falls back to pacing frames itself.
+void pace_frame(FramePacer* pacer) {
+    Uint64 now = SDL_GetPerformanceCounter();
+    if (pacer->vsync) {
+        if (!vsync_is_ignored(pacer, now)) return;
+        printf("Vsync is not limiting the frame rate, pacing frames instead\n");
+        pacer->vsync = false;
+        pacer->deadline = now + pacer->period;
+        return;
+    }
+    if (now < pacer->deadline) {
+        wait_until(pacer->deadline);
+        pacer->deadline += pacer->period;
+    } else if (now - pacer->deadline > pacer->period) {
+        pacer->deadline = now + pacer->period;
+    } else {
+        pacer->deadline += pacer->period;
+    }
+}
+
+// Sets how many fixed updates a frame may run. Returns false and keeps the current limit if
+// steps is out of range.
+bool set_max_sim_steps(int steps) {
+    if (steps < MAX_SIM_STEPS_MIN || steps > MAX_SIM_STEPS_MAX) return false;
+    max_sim_steps = steps;
+    return true;
+}
+
+// Keeps a fixed-update accumulator to at most max_sim_steps whole steps, so a slow frame can't
+// make the next one slower still by owing it more updates. The whole steps past the limit are
+// dropped, and reported to the profiler; the fraction of a step left over is kept for
+// interpolation. Returns the number of steps dropped.
+int limit_sim_steps(double* accumulator, double step) {
+    double steps = *accumulator / step;
+    if (steps < max_sim_steps + 1) return 0;
+    // Clamped before converting, since a long enough stall owes more steps than an int holds;
+    // anything left past the clamp is dropped on the next call
+    int dropped = (int)SDL_min(steps - max_sim_steps, (double)SDL_MAX_SINT32);
+    *accumulator -= dropped * step;
+    profile_dropped_time(dropped, dropped * step);
+    return dropped;
+}
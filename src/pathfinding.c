@@ -1,5 +1,9 @@
 #include "pathfinding.h"
 #include "utils.h"
+#include "cover.h"
+#include "influence.h"
+#include "random.h"
+#include "memtrack.h"
 
 int get_heuristic(int x1, int y1, int x2, int y2) {
 	int dx = absi(x1 - x2);
@@ -7,14 +11,16 @@ int get_heuristic(int x1, int y1, int x2, int y2) {
 	return 10 * (dx + dy) + (14 - 2 * 10) * (dx < dy ? dx : dy);
 }
 
-void find_path(Entity* entity, World* world, int target_x, int target_y) {
+// Finds a path for entity to the target tile with A*, leaving it in entity->path (path_length 0
+// if there is none). Returns how many nodes were expanded, for profiling.
+int find_path(Entity* entity, World* world, int target_x, int target_y) {
 	if (!entity || !world) {
 		printf("Error: Null enemy or world in find_path\n");
-		return;
+		return 0;
 	}
 	if (!is_valid_node(target_x, target_y, world)) {
 		entity->path_length = 0;
-		return;
+		return 0;
 	}
 
 	Node open_list[MAP_SIZE * MAP_SIZE];
@@ -27,8 +33,9 @@ void find_path(Entity* entity, World* world, int target_x, int target_y) {
 
 	if (!is_valid_node(start_x, start_y, world)) {
 		entity->path_length = 0;
-		return;
+		return 0;
 	}
+	note_stack_depth(STACK_FIND_PATH);
 
 	open_list[open_count++] = (Node){start_x, start_y, 0, get_heuristic(start_x, start_y, target_x, target_y), 0, -1, -1};
 	open_list[0].f = open_list[0].g + open_list[0].h;
@@ -50,7 +57,7 @@ void find_path(Entity* entity, World* world, int target_x, int target_y) {
 				if (entity->path_length >= MAP_SIZE * MAP_SIZE) {
 					entity->path_length = 0;
 					printf("Error: Path length exceeded in find_path\n");
-					return;
+					return iterations;
 				}
 				entity->path[entity->path_length++] = current.x + current.y * MAP_SIZE;
 				if (current.parent_x == -1 && current.parent_y == -1) break;
@@ -65,7 +72,7 @@ void find_path(Entity* entity, World* world, int target_x, int target_y) {
 				if (!found_parent) {
 					entity->path_length = 0;
 					printf("Error: Parent not found in find_path\n");
-					return;
+					return iterations;
 				}
 			}
 
@@ -77,7 +84,7 @@ void find_path(Entity* entity, World* world, int target_x, int target_y) {
 			} else if (entity->path_length == 1) {
 				entity->path_length = 0;
 			}
-			return;
+			return iterations;
 		}
 
 		int directions[8][2] = {
@@ -143,6 +150,7 @@ void find_path(Entity* entity, World* world, int target_x, int target_y) {
 		}
 	}
 	entity->path_length = 0;
+	return iterations;
 }
 
 void move_along_path(Enemy* enemy, World* world, int enemy_index, int last_target_x, int last_target_y) {
@@ -174,7 +182,7 @@ void move_along_path(Enemy* enemy, World* world, int enemy_index, int last_targe
         }
 
         // Cap rotation speed
-        float max_rotation = ENEMY_ROTATION_SPEED * FIXED_DT;
+        float max_rotation = ENEMY_ROTATION_SPEED * fixed_dt;
         if (angle_diff > max_rotation) angle_diff = max_rotation;
         if (angle_diff < -max_rotation) angle_diff = -max_rotation;
 
@@ -232,7 +240,7 @@ void move_along_path(Enemy* enemy, World* world, int enemy_index, int last_targe
 	bool in_small_wall = false;
     // Update velocity (continuous movement)
     if (dist > 0.0f) {
-        float speed = ENEMY_SPEED * FIXED_DT;
+        float speed = ENEMY_SPEED * fixed_dt;
         enemy->vel_x = (dx / dist) * speed;
         enemy->vel_y = (dy / dist) * speed;
 
@@ -263,7 +271,7 @@ void move_along_path(Enemy* enemy, World* world, int enemy_index, int last_targe
     float movement = my_sqrt((enemy->x - last_x[enemy_index]) * (enemy->x - last_x[enemy_index]) +
                             (enemy->y - last_y[enemy_index]) * (enemy->y - last_y[enemy_index]));
     if (movement < 1.0f && enemy->path_length > 0 && !in_small_wall) {
-        stuck_timer[enemy_index] += FIXED_DT;
+        stuck_timer[enemy_index] += fixed_dt;
         if (stuck_timer[enemy_index] >= STUCK_THRESHOLD) {
             printf("Enemy %d stuck at (%.2f, %.2f) tile (%d, %d), targeting (%d, %d), path_length=%d\n",
                 enemy_index, enemy->x, enemy->y,
@@ -297,7 +305,7 @@ void spawn_enemy(Enemy* enemy, World* world, Camera* camera, int flag_id) {
     enemy->respawn_timer = 0.0f;
     enemy->vel_x = 0.0f;
     enemy->vel_y = 0.0f;
-    enemy->angle = (float)(rand() % 360);
+    enemy->angle = (float)random_below(&enemy->spawn_random, 360);
     enemy->state = FREE;
     enemy->shoot_timer = 0.0f;
     enemy->decision_timer = 0.0f;
@@ -320,8 +328,8 @@ void spawn_enemy(Enemy* enemy, World* world, Camera* camera, int flag_id) {
 
     while (!valid_spawn && attempts < max_attempts) {
         attempts++;
-        float angle = (float)(rand() % 360) * (MA_PI / 180.0f);
-        float radius = 100.0f + (rand() % 100); // Spawn within 100-200 pixels
+        float angle = (float)random_below(&enemy->spawn_random, 360) * (MA_PI / 180.0f);
+        float radius = 100.0f + random_below(&enemy->spawn_random, 100); // Spawn within 100-200 pixels
         spawn_x = spawn_center_x + my_cosf(angle) * radius;
         spawn_y = spawn_center_y + my_sinf(angle) * radius;
 
@@ -344,6 +352,9 @@ void spawn_enemy(Enemy* enemy, World* world, Camera* camera, int flag_id) {
 
     enemy->x = spawn_x - enemy->w / 2;
     enemy->y = spawn_y - enemy->h / 2;
+    enemy->prev_x = enemy->x; // Appears in place rather than sliding in
+    enemy->prev_y = enemy->y;
+    enemy->prev_angle = enemy->angle;
 }
 
 void find_cover_point(Enemy* enemy, World* world, int player_x, int player_y, int* cover_x, int* cover_y) {
@@ -353,74 +364,45 @@ void find_cover_point(Enemy* enemy, World* world, int player_x, int player_y, in
 		return;
 	}
 
+	note_stack_depth(STACK_FIND_COVER);
+
+	// Player-dependent checks are evaluated once per player tile and shared by all enemies
+	update_cover_cache(world, player_x, player_y);
+	CoverCache* cache = &world->cover_cache;
+
 	int best_x = -1, best_y = -1;
 	float best_score = FLT_MAX;
-	int directions[4][2] = {{0, 1}, {1, 0}, {0, -1}, {-1, 0}}; // Orthogonal directions
-
-	// Search for small walls within radius
-	for (int y = 0; y < MAP_SIZE; y++) {
-		for (int x = 0; x < MAP_SIZE; x++) {
-			if (world->map[y][x] != WALL_SMALL) continue;
-
-			float wall_pixel_x = x * TILE_SIZE + TILE_SIZE / 2;
-			float wall_pixel_y = y * TILE_SIZE + TILE_SIZE / 2;
-			float dx = wall_pixel_x - (enemy->x + enemy->w / 2);
-			float dy = wall_pixel_y - (enemy->y + enemy->h / 2);
-			float dist_to_wall = my_sqrt(dx * dx + dy * dy);
-			if (dist_to_wall > MAX_COVER_DISTANCE) continue;
-
-			// Check adjacent tiles for valid cover positions
-			for (int i = 0; i < 4; i++) {
-				int cx = x + directions[i][0];
-				int cy = y + directions[i][1];
-				if (!is_valid_node(cx, cy, world)) continue;
-
-				float cover_pixel_x = cx * TILE_SIZE + TILE_SIZE / 2;
-				float cover_pixel_y = cy * TILE_SIZE + TILE_SIZE / 2;
-				float dist_to_player = my_sqrt(
-					(cover_pixel_x - (player_x * TILE_SIZE + TILE_SIZE / 2)) *
-					(cover_pixel_x - (player_x * TILE_SIZE + TILE_SIZE / 2)) +
-					(cover_pixel_y - (player_y * TILE_SIZE + TILE_SIZE / 2)) *
-					(cover_pixel_y - (player_y * TILE_SIZE + TILE_SIZE / 2))
-				);
-
-				// Check if within shooting range
-				if (dist_to_player < SHOOTING_RANGE * 0.8f || dist_to_player > SHOOTING_RANGE * 1.2f) continue;
-
-				// Check line-of-sight (no BULLETPROOF or OPAQUE walls)
-				if (!has_line_of_sight(cover_pixel_x, cover_pixel_y,
-                                       player_x * TILE_SIZE + TILE_SIZE / 2,
-                                       player_y * TILE_SIZE + TILE_SIZE / 2,
-                                       world, true, true)) {
-					continue;
-				}
-
-				// Check if the small wall is between the cover point and player
-				bool wall_between = false;
-				float wall_dx = wall_pixel_x - cover_pixel_x;
-				float wall_dy = wall_pixel_y - cover_pixel_y;
-				float player_dx = (player_x * TILE_SIZE + TILE_SIZE / 2) - cover_pixel_x;
-				float player_dy = (player_y * TILE_SIZE + TILE_SIZE / 2) - cover_pixel_y;
-
-				// Check if wall is roughly in the direction of the player
-				float dot_product = wall_dx * player_dx + wall_dy * player_dy;
-				float wall_dist = my_sqrt(wall_dx * wall_dx + wall_dy * wall_dy);
-				float player_dist = my_sqrt(player_dx * player_dx + player_dy * player_dy);
-				if (dot_product > 0 && wall_dist < player_dist) {
-					// Wall is closer to cover point than player and in the same direction
-					wall_between = true;
-				}
+	float enemy_center_x = enemy->x + enemy->w / 2;
+	float enemy_center_y = enemy->y + enemy->h / 2;
+	int enemy_tile_x = (int)(enemy_center_x / TILE_SIZE);
+	int enemy_tile_y = (int)(enemy_center_y / TILE_SIZE);
+
+	// Only visit bins that overlap the cover search radius
+	int min_bx, min_by, max_bx, max_by;
+	get_cover_bin_range(enemy_center_x, enemy_center_y, MAX_COVER_DISTANCE, &min_bx, &min_by, &max_bx, &max_by);
+
+	for (int by = min_by; by <= max_by; by++) {
+		for (int bx = min_bx; bx <= max_bx; bx++) {
+			int bin = by * COVER_BINS + bx;
+			for (int k = cache->bin_start[bin]; k < cache->bin_start[bin + 1]; k++) {
+				CoverCandidate* cand = &cache->candidates[k];
+				CoverPoint* cp = &world->cover_points[cand->point];
+
+				float dx = (cp->wall_x * TILE_SIZE + TILE_SIZE / 2) - enemy_center_x;
+				float dy = (cp->wall_y * TILE_SIZE + TILE_SIZE / 2) - enemy_center_y;
+				float dist_sq = dx * dx + dy * dy;
+				if (dist_sq > MAX_COVER_DISTANCE * MAX_COVER_DISTANCE) continue;
+
+				// Penalise crowded cover so enemies spread out (the enemy itself doesn't count)
+				float density = get_influence(world, INFLUENCE_DENSITY, cp->x, cp->y);
+				if (cp->x == enemy_tile_x && cp->y == enemy_tile_y) density = maxf(0.0f, density - 1.0f);
 
 				// Score the cover point
-				float score = dist_to_wall + dist_to_player * 0.5f;
-				if (wall_between) {
-					score *= 0.5f; // Prioritize positions with wall between
-				}
-
+				float score = (my_sqrt(dist_sq) + cand->player_score + density * COVER_DENSITY_PENALTY) * cand->weight;
 				if (score < best_score) {
 					best_score = score;
-					best_x = cx;
-					best_y = cy;
+					best_x = cp->x;
+					best_y = cp->y;
 				}
 			}
 		}
@@ -0,0 +1,113 @@
+#include "pipeline.h"
+#include "game.h"
+#include "snapshot.h"
+#include "trace.h"
+#include "timing.h"
+#include "pacing.h"
+#include "memtrack.h"
+
+// Runs fixed updates on their own clock and publishes a render snapshot after each batch of them.
+// The lock is held only while ticking, so the main thread can slip console commands and clicks in
+// between ticks; rendering never takes it.
+static int run_simulation(void* data) {
+    SimPipeline* pipeline = data;
+    name_trace_thread("simulation");
+    mark_stack_base();
+    const Uint64 frequency = SDL_GetPerformanceFrequency();
+    Uint64 last_time = SDL_GetPerformanceCounter();
+    double accumulator = 0.0;
+    Camera camera = {0};
+    SDL_LockMutex(pipeline->lock);
+    double step = fixed_dt; // Copy of fixed_dt, which console commands change under the lock
+    SDL_UnlockMutex(pipeline->lock);
+
+    while (SDL_AtomicGet(&pipeline->running)) {
+        Uint64 current_time = SDL_GetPerformanceCounter();
+        double delta_time = (double)(current_time - last_time) / frequency;
+        last_time = current_time;
+        if (SDL_AtomicGet(&pipeline->paused)) {
+            SDL_Delay(1);
+            continue;
+        }
+
+        accumulator += delta_time;
+        if (accumulator < step) {
+            // Sleep until the next tick is due; SDL_Delay may overshoot, which the accumulator absorbs
+            SDL_Delay((Uint32)((step - accumulator) * 1000.0));
+            continue;
+        }
+
+        SDL_LockMutex(pipeline->lock);
+        camera.w = SDL_AtomicGet(&pipeline->view_w);
+        camera.h = SDL_AtomicGet(&pipeline->view_h);
+        limit_sim_steps(&accumulator, fixed_dt);
+        while (accumulator >= fixed_dt) {
+            Uint64 tick_start = SDL_GetPerformanceCounter();
+            TRACE_BEGIN(tick);
+            center_camera(&camera, pipeline->player, pipeline->world);
+            save_previous_transforms(pipeline->player, pipeline->enemies, pipeline->bullets);
+            apply_player_input(pipeline->player, pipeline->world, pipeline->bullets, &pipeline->input);
+            pipeline->input.fire = false;
+            fixed_update_enemies(pipeline->player, pipeline->world, pipeline->bullets, pipeline->enemies, &camera, pipeline->game_state);
+            accumulator -= fixed_dt;
+            TRACE_END(tick, "tick", 0);
+            record_timing(TIMING_TICK, tick_start, SDL_GetPerformanceCounter());
+        }
+        publish_render_snapshot(pipeline->snapshots, pipeline->player, pipeline->world, pipeline->enemies, pipeline->bullets);
+        step = fixed_dt;
+        SDL_UnlockMutex(pipeline->lock);
+    }
+    return 0;
+}
+
+// Moves the simulation onto its own thread. The main thread keeps the window, events and renderer,
+// drawing whatever snapshot is newest, so a frame costs the slower of simulation and rendering
+// rather than their sum. Returns false (with the simulation left to the caller) on failure.
+bool start_sim_pipeline(SimPipeline* pipeline, Player* player, World* world, Enemy* enemies, Bullet* bullets, GameState* game_state, SnapshotBuffer* snapshots) {
+    pipeline->player = player;
+    pipeline->world = world;
+    pipeline->enemies = enemies;
+    pipeline->bullets = bullets;
+    pipeline->game_state = game_state;
+    pipeline->snapshots = snapshots;
+    SDL_AtomicSet(&pipeline->running, 1);
+    SDL_AtomicSet(&pipeline->paused, 0);
+    pipeline->input = (PlayerInput){0};
+    if (SDL_AtomicGet(&pipeline->view_w) == 0 || SDL_AtomicGet(&pipeline->view_h) == 0) {
+        SDL_AtomicSet(&pipeline->view_w, CAMERA_W);
+        SDL_AtomicSet(&pipeline->view_h, CAMERA_H);
+    }
+
+    pipeline->lock = SDL_CreateMutex();
+    if (!pipeline->lock) {
+        printf("Failed to create simulation lock: %s\n", SDL_GetError());
+        return false;
+    }
+    pipeline->thread = SDL_CreateThread(run_simulation, "simulation", pipeline);
+    if (!pipeline->thread) {
+        printf("Failed to create simulation thread: %s\n", SDL_GetError());
+        SDL_DestroyMutex(pipeline->lock);
+        pipeline->lock = NULL;
+        return false;
+    }
+    return true;
+}
+
+void stop_sim_pipeline(SimPipeline* pipeline) {
+    if (!pipeline->thread) return;
+    SDL_AtomicSet(&pipeline->running, 0);
+    SDL_WaitThread(pipeline->thread, NULL);
+    pipeline->thread = NULL;
+    SDL_DestroyMutex(pipeline->lock);
+    pipeline->lock = NULL;
+}
+
+// Guards changes to simulation state made from the main thread (console commands, player input, menu
+// toggles). Does nothing when the simulation runs on the main thread.
+void lock_simulation(SimPipeline* pipeline) {
+    if (pipeline->thread) SDL_LockMutex(pipeline->lock);
+}
+
+void unlock_simulation(SimPipeline* pipeline) {
+    if (pipeline->thread) SDL_UnlockMutex(pipeline->lock);
+}
@@ -0,0 +1,219 @@
+#include "profiler.h"
+#include "utils.h"
+#include "text.h"
+#include "trace.h"
+
+// Name, enclosing zone (-1 for none), graph colour and whether the tracer records each run of
+// each zone. Only zones without a parent are stacked in the frame-time graph, since the others
+// are already inside one. Zones entered once per enemy per tick aren't traced, as they would
+// fill the trace buffer in seconds; the tracer gets decisions and path searches separately.
+static const struct {
+    const char* name;
+    int parent;
+    SDL_Color color;
+    bool traced;
+} zone_info[PROFILE_ZONE_COUNT] = {
+    [PROFILE_PLAYER] = {"player", -1, {80, 200, 80, 255}, true},
+    [PROFILE_BULLETS] = {"bullets", PROFILE_PLAYER, {140, 220, 140, 255}, true},
+    [PROFILE_ENEMIES] = {"enemies", -1, {220, 70, 70, 255}, true},
+    [PROFILE_SPAWN] = {"spawning", PROFILE_ENEMIES, {240, 150, 150, 255}, true},
+    [PROFILE_INFLUENCE] = {"influence", PROFILE_ENEMIES, {240, 150, 150, 255}, true},
+    [PROFILE_DECISIONS] = {"decisions", PROFILE_ENEMIES, {240, 150, 150, 255}, false},
+    [PROFILE_PATHFINDING] = {"find_path", PROFILE_DECISIONS, {240, 190, 190, 255}, false},
+    [PROFILE_COVER] = {"find_cover", PROFILE_DECISIONS, {240, 190, 190, 255}, false},
+    [PROFILE_MOVEMENT] = {"movement", PROFILE_ENEMIES, {240, 150, 150, 255}, false},
+    [PROFILE_HITS] = {"bullet hits", PROFILE_ENEMIES, {240, 150, 150, 255}, false},
+    [PROFILE_SNAPSHOT] = {"snapshot", -1, {240, 160, 40, 255}, true},
+    [PROFILE_RENDER_MAP] = {"draw map", -1, {70, 110, 230, 255}, true},
+    [PROFILE_RENDER_SPRITES] = {"draw sprites", -1, {60, 200, 220, 255}, true},
+    [PROFILE_RENDER_BULLETS] = {"draw bullets", -1, {230, 230, 60, 255}, true},
+    [PROFILE_RENDER_FOV] = {"draw fov", -1, {170, 90, 220, 255}, true},
+    [PROFILE_RENDER_HUD] = {"draw hud", -1, {220, 220, 220, 255}, true},
+    [PROFILE_RENDER_CONSOLE] = {"draw console", -1, {150, 180, 120, 255}, true},
+    [PROFILE_RENDER_MINIMAP] = {"draw minimap", -1, {60, 160, 140, 255}, true},
+    [PROFILE_RENDER_MENU] = {"draw menu", -1, {230, 120, 200, 255}, true},
+    [PROFILE_PRESENT] = {"present", -1, {110, 110, 160, 255}, true}
+};
+
+// Recorded so far this frame; the sim thread adds to it too, so it is kept under a lock. 64 bits,
+// so a hitch of seconds in one zone can't wrap around into the outliers the profiler is for.
+static Uint64 frame_ns[PROFILE_ZONE_COUNT];
+static SDL_SpinLock frame_ns_lock;
+static SDL_atomic_t dropped_us;   // Simulation time dropped so far this frame
+static ProfileFrame history[PROFILE_HISTORY];
+static int history_next = 0;
+static int history_count = 0;
+static Uint64 last_frame_end = 0;
+static bool overlay_visible = false;
+
+// Adds a run of a zone, from start to end (performance counter values), to the current frame
+// and to the trace if one is being recorded. Safe to call from any thread.
+void profile_record(ProfileZone zone, Uint64 start, Uint64 end) {
+    Uint64 ns = (Uint64)((double)(end - start) * 1000000000.0 / SDL_GetPerformanceFrequency());
+    SDL_AtomicLock(&frame_ns_lock);
+    frame_ns[zone] += ns;
+    SDL_AtomicUnlock(&frame_ns_lock);
+    if (zone_info[zone].traced) trace_event(zone_info[zone].name, start, end, 0);
+}
+
+// Adds a tick's summed zones to the current frame, taking the lock once for all of them. Not
+// traced, since a sum has no single start and end. Safe to call from any thread.
+void profile_record_sum(const ProfileSum* sum) {
+    double ns_per_tick = 1000000000.0 / SDL_GetPerformanceFrequency();
+    SDL_AtomicLock(&frame_ns_lock);
+    for (int i = 0; i < PROFILE_ZONE_COUNT; i++) frame_ns[i] += (Uint64)(sum->ticks[i] * ns_per_tick);
+    SDL_AtomicUnlock(&frame_ns_lock);
+}
+
+// Notes that steps fixed updates, seconds of simulation time, were dropped for running behind.
+// Safe to call from any thread.
+void profile_dropped_time(int steps, double seconds) {
+    int us = (int)SDL_min(seconds * 1000000.0, (double)SDL_MAX_SINT32);
+    SDL_AtomicAdd(&dropped_us, us);
+    Uint64 now = SDL_GetPerformanceCounter();
+    trace_event("dropped time", now, now, 2, "steps", steps, "us", us);
+}
+
+// Closes the current frame, moving what its zones recorded into the history
+void profile_end_frame(void) {
+    Uint64 now = SDL_GetPerformanceCounter();
+    ProfileFrame* frame = &history[history_next];
+    SDL_AtomicLock(&frame_ns_lock);
+    for (int i = 0; i < PROFILE_ZONE_COUNT; i++) {
+        frame->zone_ms[i] = (float)(frame_ns[i] / 1000000.0);
+        frame_ns[i] = 0;
+    }
+    SDL_AtomicUnlock(&frame_ns_lock);
+    frame->dropped_ms = SDL_AtomicSet(&dropped_us, 0) / 1000.0f;
+    frame->frame_ms = last_frame_end ? (float)((double)(now - last_frame_end) * 1000.0 / SDL_GetPerformanceFrequency()) : 0.0f;
+    if (last_frame_end) trace_event("frame", last_frame_end, now, 0);
+    last_frame_end = now;
+    history_next = (history_next + 1) % PROFILE_HISTORY;
+    if (history_count < PROFILE_HISTORY) history_count++;
+}
+
+// Returns the frame closed age frames ago (0 is the latest), or NULL if there is none
+const ProfileFrame* get_profile_frame(int age) {
+    if (age < 0 || age >= history_count) return NULL;
+    return &history[(history_next - 1 - age + PROFILE_HISTORY) % PROFILE_HISTORY];
+}
+
+static int compare_floats(const void* a, const void* b) {
+    float fa = *(const float*)a, fb = *(const float*)b;
+    return (fa > fb) - (fa < fb);
+}
+
+// Fills stats for one zone over the history. PROFILE_ZONE_COUNT gives the whole frame instead.
+void get_profile_stats(ProfileZone zone, ProfileStats* stats) {
+    static float values[PROFILE_HISTORY];
+    float sum = 0.0f;
+    for (int i = 0; i < history_count; i++) {
+        const ProfileFrame* frame = get_profile_frame(i);
+        values[i] = zone == PROFILE_ZONE_COUNT ? frame->frame_ms : frame->zone_ms[zone];
+        sum += values[i];
+    }
+    if (history_count == 0) {
+        *stats = (ProfileStats){0.0f, 0.0f, 0.0f};
+        return;
+    }
+    qsort(values, history_count, sizeof(float), compare_floats);
+    stats->min_ms = values[0];
+    stats->avg_ms = sum / history_count;
+    stats->p99_ms = values[(history_count * 99 + 99) / 100 - 1];
+}
+
+const char* get_profile_zone_name(ProfileZone zone) {
+    return zone_info[zone].name;
+}
+
+// Returns how many zones enclose this one
+int get_profile_zone_depth(ProfileZone zone) {
+    int depth = 0;
+    for (int parent = zone_info[zone].parent; parent >= 0; parent = zone_info[parent].parent) depth++;
+    return depth;
+}
+
+// Shows or hides the overlay. Returns false, leaving it hidden, in builds without the profiler.
+bool toggle_profiler_overlay(void) {
+#ifdef ENABLE_PROFILER
+    overlay_visible = !overlay_visible;
+    return true;
+#else
+    return false;
+#endif
+}
+
+// Draws the last PROFILE_HISTORY frames as stacked bars, one pixel column per frame, and
+// each zone's min/avg/p99 below them
+void render_profiler(SDL_Renderer* renderer, GlyphAtlas* glyphs) {
+    if (!overlay_visible || history_count == 0 || !glyphs || !glyphs->texture) return;
+
+    int line_h = glyphs->line_height;
+    int panel_x = 10, panel_y = 10 + 3 * line_h;
+    int text_w = measure_text(glyphs, "    find_cover      00.00  00.00  00.00");
+    int panel_w = SDL_max(PROFILE_HISTORY, text_w) + 20;
+    int panel_h = PROFILE_GRAPH_H + 30 + (PROFILE_ZONE_COUNT + 3) * line_h;
+    SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
+    SDL_SetRenderDrawColor(renderer, 0, 0, 0, 180);
+    SDL_RenderFillRect(renderer, &(SDL_Rect){panel_x, panel_y, panel_w, panel_h});
+
+    // Stack the top-level zones bottom up, then whatever of the frame they don't cover
+    int graph_x = panel_x + 10 + PROFILE_HISTORY - history_count;
+    int graph_bottom = panel_y + 10 + PROFILE_GRAPH_H;
+    static float stacked[PROFILE_HISTORY];
+    static SDL_Rect bars[PROFILE_HISTORY];
+    for (int i = 0; i < history_count; i++) stacked[i] = 0.0f;
+    for (int zone = 0; zone <= PROFILE_ZONE_COUNT; zone++) {
+        if (zone < PROFILE_ZONE_COUNT && zone_info[zone].parent >= 0) continue;
+        int bar_count = 0;
+        for (int i = 0; i < history_count; i++) {
+            const ProfileFrame* frame = get_profile_frame(history_count - 1 - i);
+            float ms = zone < PROFILE_ZONE_COUNT ? frame->zone_ms[zone] : frame->frame_ms - stacked[i];
+            if (ms <= 0.0f) continue;
+            int bottom = (int)minf(stacked[i] * PROFILE_GRAPH_SCALE, PROFILE_GRAPH_H);
+            stacked[i] += ms;
+            int top = (int)minf(stacked[i] * PROFILE_GRAPH_SCALE, PROFILE_GRAPH_H);
+            if (top > bottom) bars[bar_count++] = (SDL_Rect){graph_x + i, graph_bottom - top, 1, top - bottom};
+        }
+        SDL_Color color = zone < PROFILE_ZONE_COUNT ? zone_info[zone].color : (SDL_Color){70, 70, 70, 255};
+        SDL_SetRenderDrawColor(renderer, color.r, color.g, color.b, 255);
+        SDL_RenderFillRects(renderer, bars, bar_count);
+    }
+    // Frames that dropped simulation time get a red tick above the graph
+    int bar_count = 0;
+    float dropped_ms = 0.0f;
+    int dropped_frames = 0;
+    for (int i = 0; i < history_count; i++) {
+        const ProfileFrame* frame = get_profile_frame(history_count - 1 - i);
+        if (frame->dropped_ms <= 0.0f) continue;
+        dropped_ms += frame->dropped_ms;
+        dropped_frames++;
+        bars[bar_count++] = (SDL_Rect){graph_x + i, graph_bottom - PROFILE_GRAPH_H - 6, 1, 4};
+    }
+    SDL_SetRenderDrawColor(renderer, 255, 40, 40, 255);
+    SDL_RenderFillRects(renderer, bars, bar_count);
+    int target_y = graph_bottom - (int)(TARGET_FRAME_TIME * PROFILE_GRAPH_SCALE);
+    SDL_SetRenderDrawColor(renderer, 255, 255, 255, 120);
+    SDL_RenderDrawLine(renderer, panel_x + 10, target_y, panel_x + 10 + PROFILE_HISTORY, target_y);
+
+    static TextBatch batch;
+    char line[64];
+    ProfileStats stats;
+    int text_y = graph_bottom + 10;
+    begin_text_batch(&batch, renderer, glyphs);
+    add_text(&batch, "ms                  min    avg    p99", panel_x + 10, text_y, (SDL_Color){255, 255, 255, 255});
+    get_profile_stats(PROFILE_ZONE_COUNT, &stats);
+    snprintf(line, sizeof(line), "frame             %5.2f  %5.2f  %5.2f", stats.min_ms, stats.avg_ms, stats.p99_ms);
+    add_text(&batch, line, panel_x + 10, text_y + line_h, (SDL_Color){255, 255, 255, 255});
+    for (int zone = 0; zone < PROFILE_ZONE_COUNT; zone++) {
+        get_profile_stats(zone, &stats);
+        int indent = 2 * get_profile_zone_depth(zone);
+        snprintf(line, sizeof(line), "%*s%-*s %5.2f  %5.2f  %5.2f", indent, "", 17 - indent, zone_info[zone].name,
+                 stats.min_ms, stats.avg_ms, stats.p99_ms);
+        add_text(&batch, line, panel_x + 10, text_y + (zone + 2) * line_h, zone_info[zone].color);
+    }
+    snprintf(line, sizeof(line), "dropped %.1f ms in %d frames", dropped_ms, dropped_frames);
+    add_text(&batch, line, panel_x + 10, text_y + (PROFILE_ZONE_COUNT + 2) * line_h,
+             dropped_frames ? (SDL_Color){255, 40, 40, 255} : (SDL_Color){255, 255, 255, 255});
+    flush_text_batch(&batch);
+}
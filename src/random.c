@@ -0,0 +1,51 @@
+#include "random.h"
+
+// Builds the stream selector for one subsystem's stream belonging to one object (e.g. enemy slot).
+// Every object draws from its own stream, so the numbers it gets don't depend on the order
+// objects are updated in, or on which thread updates them.
+Uint64 random_stream_selector(RandomSubsystem subsystem, int index) {
+    return ((Uint64)subsystem << 32) | (Uint32)index;
+}
+
+// Seeds a PCG32 stream (O'Neill's pcg32_srandom_r)
+void init_random_stream(RandomStream* rng, Uint64 seed, Uint64 selector) {
+    rng->state = 0;
+    rng->inc = (selector << 1) | 1;
+    next_random(rng);
+    rng->state += seed;
+    next_random(rng);
+}
+
+// Returns the stream's next 32 random bits
+Uint32 next_random(RandomStream* rng) {
+    Uint64 old_state = rng->state;
+    rng->state = old_state * 6364136223846793005ULL + rng->inc;
+    Uint32 xorshifted = (Uint32)(((old_state >> 18) ^ old_state) >> 27);
+    Uint32 rotation = (Uint32)(old_state >> 59);
+    return (xorshifted >> rotation) | (xorshifted << ((-rotation) & 31));
+}
+
+// Returns a random integer in [0, bound). Scales rather than takes a modulo, so it needs
+// no division; the bias is at most bound / 2^32.
+int random_below(RandomStream* rng, int bound) {
+    if (bound <= 0) return 0;
+    return (int)(((Uint64)next_random(rng) * (Uint32)bound) >> 32);
+}
+
+// Gives every enemy slot its own spawn and wander streams. Call before the first spawn.
+void seed_enemy_random(Enemy* enemies, Uint64 seed) {
+    for (int i = 0; i < MAX_ENEMIES; i++) {
+        init_random_stream(&enemies[i].spawn_random, seed, random_stream_selector(RANDOM_SPAWN, i));
+        init_random_stream(&enemies[i].wander_random, seed, random_stream_selector(RANDOM_WANDER, i));
+    }
+}
+
+// Reads a decimal seed from the command line. Returns false if text isn't one.
+bool parse_seed(const char* text, Uint64* seed) {
+    if (!text || !*text) return false;
+    char* end = NULL;
+    unsigned long long value = strtoull(text, &end, 10);
+    if (*end != '\0') return false;
+    *seed = (Uint64)value;
+    return true;
+}
@@ -0,0 +1,200 @@
+#include "raycast.h"
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+// Per-ray DDA state: the tile the ray is in and the distance at which it crosses the next
+// vertical (t_max_x) and horizontal (t_max_y) grid line
+typedef struct{
+    int tile_x, tile_y;
+    int step_x, step_y;
+    float t_max_x, t_max_y;
+    float t_delta_x, t_delta_y;
+} RayState;
+
+static void init_ray_state(RayState* s, float origin_x, float origin_y, float dir_x, float dir_y) {
+    s->tile_x = (int)(origin_x / TILE_SIZE);
+    s->tile_y = (int)(origin_y / TILE_SIZE);
+    s->step_x = (dir_x > 0) ? 1 : -1;
+    s->step_y = (dir_y > 0) ? 1 : -1;
+    // Axis-parallel rays never cross the other axis' grid lines
+    float abs_x = dir_x > 0 ? dir_x : -dir_x;
+    float abs_y = dir_y > 0 ? dir_y : -dir_y;
+    s->t_delta_x = (dir_x != 0) ? TILE_SIZE / abs_x : 1e30f;
+    s->t_delta_y = (dir_y != 0) ? TILE_SIZE / abs_y : 1e30f;
+    s->t_max_x = (dir_x != 0) ? (dir_x > 0 ? (s->tile_x + 1) * TILE_SIZE - origin_x : origin_x - s->tile_x * TILE_SIZE) / abs_x : 1e30f;
+    s->t_max_y = (dir_y != 0) ? (dir_y > 0 ? (s->tile_y + 1) * TILE_SIZE - origin_y : origin_y - s->tile_y * TILE_SIZE) / abs_y : 1e30f;
+}
+
+static bool tile_blocks(int x, int y, unsigned block_mask, World* world) {
+    return (block_mask >> world->map[y][x]) & 1u;
+}
+
+// Traces one ray through the grid
+static float trace_ray(RayState* s, float max_dist, unsigned block_mask, World* world, int* tile_out) {
+    float dist = 0.0f;
+    while (dist < max_dist) {
+        if (s->tile_x < 0 || s->tile_x >= MAP_SIZE || s->tile_y < 0 || s->tile_y >= MAP_SIZE) break;
+        if (tile_blocks(s->tile_x, s->tile_y, block_mask, world)) {
+            *tile_out = s->tile_y * MAP_SIZE + s->tile_x;
+            return dist;
+        }
+        if (s->t_max_x < s->t_max_y) {
+            dist = s->t_max_x;
+            s->t_max_x += s->t_delta_x;
+            s->tile_x += s->step_x;
+        } else {
+            dist = s->t_max_y;
+            s->t_max_y += s->t_delta_y;
+            s->tile_y += s->step_y;
+        }
+    }
+    *tile_out = -1;
+    return max_dist;
+}
+
+#if defined(__SSE2__)
+// The map with a one-tile border, as 0 (pass), 1 (blocks the ray) or 2 (off the map), so the
+// packet loop needs no bounds checks, plus one free cell where idle lanes park. One table per
+// block mask, rebuilt when the map changes. The tables are shared and unlocked, so packet casts
+// belong to the thread that ticks the simulation (FOV snapshots and the influence map).
+#define RAY_TABLE_STRIDE (MAP_SIZE + 2)
+#define RAY_PARK_CELL (RAY_TABLE_STRIDE * RAY_TABLE_STRIDE)
+#define RAY_MASK_COUNT 32
+
+static const uint8_t* get_block_table(unsigned block_mask, World* world) {
+    static uint8_t tables[RAY_MASK_COUNT][RAY_PARK_CELL + 1];
+    static World* table_world[RAY_MASK_COUNT];
+    static int table_version[RAY_MASK_COUNT];
+    unsigned m = block_mask % RAY_MASK_COUNT;
+    if (table_world[m] != world || table_version[m] != world->map_version) {
+        for (int y = 0; y < RAY_TABLE_STRIDE; y++) {
+            for (int x = 0; x < RAY_TABLE_STRIDE; x++) {
+                bool border = x == 0 || y == 0 || x == RAY_TABLE_STRIDE - 1 || y == RAY_TABLE_STRIDE - 1;
+                tables[m][y * RAY_TABLE_STRIDE + x] = border ? 2 : tile_blocks(x - 1, y - 1, block_mask, world);
+            }
+        }
+        table_world[m] = world;
+        table_version[m] = world->map_version;
+    }
+    return tables[m];
+}
+
+// Traces rays four at a time. The lanes step in lockstep in SSE registers with no branch on which
+// grid line comes first, tracking each lane's position as an index into the block table. SSE2 has
+// no gather, so the four table bytes are fetched per lane and only when one of them is set (or a
+// lane runs out of range) does the loop drop to scalar code to finish the lane and load the next
+// ray into it, so short rays do not wait for long ones.
+static void trace_rays_sse2(float origin_x, float origin_y, const float* dir_x, const float* dir_y, int count,
+                            float max_dist, unsigned block_mask, World* world, float* dist_out, int* tile_out) {
+    const uint8_t* table = get_block_table(block_mask, world);
+
+    // Lane state, spilled to these arrays only when a lane needs attention
+    _Alignas(16) float t_max_x[4], t_max_y[4], t_delta_x[4], t_delta_y[4], dist[4];
+    _Alignas(16) int cell[4], step_x[4], step_y[4];
+    int ray[4] = {-1, -1, -1, -1}; // Ray traced in each lane, -1 when idle
+    int next = 0, active = 0;
+
+    for (;;) {
+        // Finish lanes that hit something or ran out, and refill idle lanes
+        for (int i = 0; i < 4; i++) {
+            for (;;) {
+                if (ray[i] < 0) {
+                    if (next >= count) {
+                        // Idle lanes park on the free cell and never step off it
+                        t_max_x[i] = t_max_y[i] = t_delta_x[i] = t_delta_y[i] = dist[i] = 0.0f;
+                        cell[i] = RAY_PARK_CELL;
+                        step_x[i] = step_y[i] = 0;
+                        break;
+                    }
+                    RayState s;
+                    init_ray_state(&s, origin_x, origin_y, dir_x[next], dir_y[next]);
+                    if (s.tile_x < 0 || s.tile_x >= MAP_SIZE || s.tile_y < 0 || s.tile_y >= MAP_SIZE || max_dist <= 0.0f) {
+                        dist_out[next] = max_dist;
+                        tile_out[next++] = -1;
+                        continue;
+                    }
+                    t_max_x[i] = s.t_max_x; t_max_y[i] = s.t_max_y;
+                    t_delta_x[i] = s.t_delta_x; t_delta_y[i] = s.t_delta_y;
+                    cell[i] = (s.tile_y + 1) * RAY_TABLE_STRIDE + s.tile_x + 1;
+                    step_x[i] = s.step_x;
+                    step_y[i] = s.step_y * RAY_TABLE_STRIDE;
+                    dist[i] = 0.0f;
+                    ray[i] = next++;
+                    active++;
+                }
+                uint8_t hit = table[cell[i]];
+                bool miss = dist[i] >= max_dist || hit == 2;
+                if (!miss && !hit) break;
+                dist_out[ray[i]] = miss ? max_dist : dist[i];
+                tile_out[ray[i]] = miss ? -1 : (cell[i] / RAY_TABLE_STRIDE - 1) * MAP_SIZE + cell[i] % RAY_TABLE_STRIDE - 1;
+                ray[i] = -1;
+                active--;
+            }
+        }
+        if (active == 0) break;
+
+        __m128 tmx = _mm_load_ps(t_max_x), tmy = _mm_load_ps(t_max_y);
+        __m128 tdx = _mm_load_ps(t_delta_x), tdy = _mm_load_ps(t_delta_y);
+        __m128 d = _mm_load_ps(dist);
+        __m128i c = _mm_load_si128((__m128i*)cell);
+        __m128i sx = _mm_load_si128((__m128i*)step_x), sy = _mm_load_si128((__m128i*)step_y);
+        __m128 limit = _mm_set1_ps(max_dist);
+        __m128i idle = _mm_setr_epi32(ray[0] < 0 ? -1 : 0, ray[1] < 0 ? -1 : 0, ray[2] < 0 ? -1 : 0, ray[3] < 0 ? -1 : 0);
+
+        for (;;) {
+            // Step every lane across whichever grid line comes first
+            __m128 step_in_x = _mm_cmplt_ps(tmx, tmy);
+            __m128i step_in_x_i = _mm_castps_si128(step_in_x);
+            d = _mm_or_ps(_mm_and_ps(step_in_x, tmx), _mm_andnot_ps(step_in_x, tmy));
+            tmx = _mm_add_ps(tmx, _mm_and_ps(step_in_x, tdx));
+            tmy = _mm_add_ps(tmy, _mm_andnot_ps(step_in_x, tdy));
+            c = _mm_add_epi32(c, _mm_or_si128(_mm_and_si128(step_in_x_i, sx), _mm_andnot_si128(step_in_x_i, sy)));
+
+            int flags = table[_mm_cvtsi128_si32(c)] | table[_mm_cvtsi128_si32(_mm_shuffle_epi32(c, 1))] |
+                        table[_mm_cvtsi128_si32(_mm_shuffle_epi32(c, 2))] | table[_mm_cvtsi128_si32(_mm_shuffle_epi32(c, 3))];
+            __m128 over = _mm_andnot_ps(_mm_castsi128_ps(idle), _mm_cmpge_ps(d, limit));
+            if (flags | _mm_movemask_ps(over)) break;
+        }
+
+        _mm_store_ps(t_max_x, tmx);
+        _mm_store_ps(t_max_y, tmy);
+        _mm_store_ps(dist, d);
+        _mm_store_si128((__m128i*)cell, c);
+    }
+}
+#endif
+
+// Casts count rays from one origin through the tile map and writes the distance to the first
+// tile whose type is in block_mask (max_dist if none is hit first) and that tile's index
+// (y * MAP_SIZE + x, or -1 on a miss; tile_out may be NULL). Distances are in units of the
+// direction's length: unit directions give pixels, origin-to-target vectors give a 0..1 fraction.
+// Rays are traced four at a time with SSE2 where available.
+void cast_rays(float origin_x, float origin_y, const float* dir_x, const float* dir_y, int count, float max_dist,
+               unsigned block_mask, World* world, float* dist_out, int* tile_out) {
+    int scratch_tiles[FOV_MAX_RAYS]; // Tiles nobody asked for, on the stack so callers don't share it
+#if defined(__SSE2__)
+    for (int i = 0; i < count; i += FOV_MAX_RAYS) {
+        int batch = count - i < FOV_MAX_RAYS ? count - i : FOV_MAX_RAYS;
+        trace_rays_sse2(origin_x, origin_y, dir_x + i, dir_y + i, batch, max_dist, block_mask, world,
+                        dist_out + i, tile_out ? tile_out + i : scratch_tiles);
+    }
+#else
+    for (int i = 0; i < count; i++) {
+        RayState state;
+        init_ray_state(&state, origin_x, origin_y, dir_x[i], dir_y[i]);
+        dist_out[i] = trace_ray(&state, max_dist, block_mask, world, tile_out ? &tile_out[i] : &scratch_tiles[0]);
+    }
+#endif
+}
+
+// Casts a single ray; see cast_rays
+float cast_ray(float origin_x, float origin_y, float dir_x, float dir_y, float max_dist,
+               unsigned block_mask, World* world, int* tile_out) {
+    RayState state;
+    int tile;
+    init_ray_state(&state, origin_x, origin_y, dir_x, dir_y);
+    float dist = trace_ray(&state, max_dist, block_mask, world, &tile);
+    if (tile_out) *tile_out = tile;
+    return dist;
+}
@@ -2,9 +2,59 @@
 #include "utils.h"
 #include "command.h"
 #include "menu.h"
+#include "fog.h"
+#include "chunks.h"
+#include "sprites.h"
+#include "text.h"
+#include "profiler.h"
+#include "memtrack.h"
+
+// Bakes the static part of the minimap (background and walls) into world->minimap_texture
+static void bake_minimap(SDL_Renderer* renderer, World* world, int minimap_w, int minimap_h, float scale) {
+    if (!world->minimap_texture) {
+        world->minimap_texture = create_tracked_texture(renderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET, minimap_w, minimap_h, "minimap");
+        if (!world->minimap_texture) {
+            printf("Failed to create minimap texture: %s\n", SDL_GetError());
+            return;
+        }
+        SDL_SetTextureBlendMode(world->minimap_texture, SDL_BLENDMODE_BLEND);
+    }
+
+    SDL_Texture* target = SDL_GetRenderTarget(renderer);
+    SDL_BlendMode blend_mode;
+    SDL_GetRenderDrawBlendMode(renderer, &blend_mode);
+    SDL_SetRenderTarget(renderer, world->minimap_texture);
+    SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_NONE);
+
+    // Semi-transparent blue background, blended onto the screen when the texture is drawn
+    SDL_SetRenderDrawColor(renderer, 0, 55, 200, 155);
+    SDL_RenderClear(renderer);
+
+    // All walls in one call
+    static SDL_Rect wall_rects[MAP_SIZE * MAP_SIZE];
+    int wall_count = 0;
+    for (int i = 0; i < world->wall_count; i++) {
+        if (world->walls[i].type != WALL_NONE && wall_count < MAP_SIZE * MAP_SIZE) {
+            wall_rects[wall_count++] = (SDL_Rect){
+                (int)(world->walls[i].x * scale),
+                (int)(world->walls[i].y * scale),
+                (int)(world->walls[i].w * scale),
+                (int)(world->walls[i].h * scale)
+            };
+        }
+    }
+    SDL_SetRenderDrawColor(renderer, 128, 128, 128, 255); // gray
+    SDL_RenderFillRects(renderer, wall_rects, wall_count);
+
+    SDL_SetRenderDrawBlendMode(renderer, blend_mode);
+    SDL_SetRenderTarget(renderer, target);
+    world->minimap_version = world->map_version;
+}
 
 // Renders a minimap to the screen showing walls, player, bullets, enemies, and camera view.
-void render_minimap(SDL_Renderer* renderer, Player* player, Bullet* bullets, Camera* camera, World* world, Enemy* enemies) {
+// The background and walls come from a texture baked on map changes; the moving markers are
+// gathered per colour from the snapshot and drawn with one call each.
+void render_minimap(SDL_Renderer* renderer, const RenderSnapshot* snap, Player* player, Camera* camera, World* world) {
     // Safety check: if renderer is null, print an error and exit the function.
     if (!renderer) {
         printf("Error: Null renderer in render_minimap\n");
@@ -18,23 +68,13 @@ void render_minimap(SDL_Renderer* renderer, Player* player, Bullet* bullets, Cam
     // Calculate scaling factor between world size and minimap size.
     float scale = (float)minimap_w / world->w;
 
-    // Draw the minimap background (semi-transparent blue).
-    SDL_SetRenderDrawColor(renderer, 0, 55, 200, 155);
+    // Draw the baked background and walls, re-baking them if the map changed.
+    if (!world->minimap_texture || world->minimap_version != world->map_version) {
+        bake_minimap(renderer, world, minimap_w, minimap_h, scale);
+    }
     SDL_Rect minimap_rect = {minimap_x, minimap_y, minimap_w, minimap_h};
-    SDL_RenderFillRect(renderer, &minimap_rect);
-
-    // Draw all walls on the minimap.
-    for (int i = 0; i < world->wall_count; i++) {
-        if (world->walls[i].type != WALL_NONE) {
-            SDL_Rect wall_rect = {
-                minimap_x + (int)(world->walls[i].x * scale),
-                minimap_y + (int)(world->walls[i].y * scale),
-                (int)(world->walls[i].w * scale),
-                (int)(world->walls[i].h * scale)
-            };
-            SDL_SetRenderDrawColor(renderer, 128, 128, 128, 255); // gray
-            SDL_RenderFillRect(renderer, &wall_rect);
-        }
+    if (world->minimap_texture) {
+        SDL_RenderCopy(renderer, world->minimap_texture, NULL, &minimap_rect);
     }
 
     // Draw the player as a white rectangle.
@@ -48,48 +88,59 @@ void render_minimap(SDL_Renderer* renderer, Player* player, Bullet* bullets, Cam
     SDL_RenderFillRect(renderer, &player_rect);
 
     // Draw all active bullets as small yellow squares (2x2).
-    for (int i = 0; i < MAX_BULLETS; i++) {
-        if (bullets[i].active) {
-            SDL_Rect bullet_rect = {
-                minimap_x + (int)(bullets[i].x * scale),
-                minimap_y + (int)(bullets[i].y * scale),
-                2, 2
-            };
-            SDL_SetRenderDrawColor(renderer, 255, 255, 0, 255); // yellow
-            SDL_RenderFillRect(renderer, &bullet_rect);
-        }
+    static SDL_Rect bullet_rects[MAX_BULLETS];
+    int bullet_count = 0;
+    for (int i = 0; i < snap->bullet_count; i++) {
+        bullet_rects[bullet_count++] = (SDL_Rect){
+            minimap_x + (int)(snap->bullets[i].x * scale),
+            minimap_y + (int)(snap->bullets[i].y * scale),
+            2, 2
+        };
     }
+    SDL_SetRenderDrawColor(renderer, 255, 255, 0, 255); // yellow
+    SDL_RenderFillRects(renderer, bullet_rects, bullet_count);
 
     // Draw all active enemies. Cyan if in cover, magenta if exposed.
-    for (int i = 0; i < MAX_ENEMIES; i++) {
-        if (enemies[i].active) {
-            SDL_Rect enemy_rect = {
-                minimap_x + (int)(enemies[i].x * scale),
-                minimap_y + (int)(enemies[i].y * scale),
-                (int)(enemies[i].w * scale),
-                (int)(enemies[i].h * scale)
-            };
-            if(enemies[i].in_cover){
-                SDL_SetRenderDrawColor(renderer, 0, 255, 255, 255); // cyan
-            } else {
-                SDL_SetRenderDrawColor(renderer, 255, 0, 255, 255); // magenta
-            }
-            SDL_RenderFillRect(renderer, &enemy_rect);
+    static SDL_Rect cover_rects[MAX_ENEMIES], exposed_rects[MAX_ENEMIES];
+    int cover_count = 0, exposed_count = 0;
+    for (int i = 0; i < snap->enemy_count; i++) {
+        const EnemyView* enemy = &snap->enemies[i];
+        SDL_Rect enemy_rect = {
+            minimap_x + (int)(enemy->x * scale),
+            minimap_y + (int)(enemy->y * scale),
+            (int)(enemy->w * scale),
+            (int)(enemy->h * scale)
+        };
+        if (enemy->in_cover) {
+            cover_rects[cover_count++] = enemy_rect;
+        } else {
+            exposed_rects[exposed_count++] = enemy_rect;
         }
     }
-
-	for (int i = 0; i < world->flag_count; i++) {
+    SDL_SetRenderDrawColor(renderer, 0, 255, 255, 255); // cyan
+    SDL_RenderFillRects(renderer, cover_rects, cover_count);
+    SDL_SetRenderDrawColor(renderer, 255, 0, 255, 255); // magenta
+    SDL_RenderFillRects(renderer, exposed_rects, exposed_count);
+
+    // Draw active flags in green, flushing the batch if there are more flags than it holds.
+    SDL_SetRenderDrawColor(renderer, 0, 255, 0, 255); // Green for flags
+    SDL_Rect flag_rects[64];
+    int flag_count = 0;
+    for (int i = 0; i < world->flag_count; i++) {
         if (world->flags[i].active) {
-            SDL_Rect flag_rect = {
+            if (flag_count == 64) {
+                SDL_RenderFillRects(renderer, flag_rects, flag_count);
+                flag_count = 0;
+            }
+            flag_rects[flag_count++] = (SDL_Rect){
                 minimap_x + (int)(world->flags[i].x * scale),
                 minimap_y + (int)(world->flags[i].y * scale),
                 (int)(world->flags[i].w * scale),
                 (int)(world->flags[i].h * scale)
             };
-            SDL_SetRenderDrawColor(renderer, 0, 255, 0, 255); // Green for flags
-            SDL_RenderFillRect(renderer, &flag_rect);
         }
     }
+    SDL_RenderFillRects(renderer, flag_rects, flag_count);
 
     // Draw the camera viewport as a red rectangle on the minimap.
     SDL_Rect camera_rect = {
@@ -102,25 +153,170 @@ void render_minimap(SDL_Renderer* renderer, Player* player, Bullet* bullets, Cam
     SDL_RenderDrawRect(renderer, &camera_rect);
 }
 
+// Requested FOV backend and software mask downscale; applied the next time the mask is created
+static FovBackend fov_backend = FOV_BACKEND_AUTO;
+static int fov_soft_scale = FOV_SOFT_SCALE;
+// Downscale of the current mask texture: 0 for a render target, otherwise a streaming texture at 1/scale
+static int fov_mask_scale = 0;
+
+void set_fov_backend(FovBackend backend, int soft_scale) {
+    fov_backend = backend;
+    fov_soft_scale = soft_scale < 1 ? 1 : soft_scale;
+}
+
+// Inputs the FOV mask was last drawn for, so frames where nothing changed can reuse it
+static bool fov_cache_valid = false;           // Whether the current mask texture holds a drawn mask
+static Uint32 fov_cache_hash = 0;              // Hash of the polygons and the player centre they were drawn around
+static int fov_cache_sector_rays = 0, fov_cache_circle_rays = 0; // Vertex counts, checked too since hashes can collide
+static float fov_cache_player_x = 0.0f, fov_cache_player_y = 0.0f; // Player centre the mask was drawn around
+static float fov_cache_camera_x = 0.0f, fov_cache_camera_y = 0.0f; // Camera offset the mask was drawn at
+
+// Forces the next render_fov to redraw the mask (e.g. after the renderer lost its target textures,
+// or the mask was recreated)
+void invalidate_fov_mask(void) {
+    fov_cache_valid = false;
+}
+
 void init_fov_mask(SDL_Renderer* renderer, SDL_Texture** fov_mask, int w, int h) {
-    if (*fov_mask) {
-        SDL_DestroyTexture(*fov_mask);
-        *fov_mask = NULL;
+    invalidate_fov_mask(); // A new texture may reuse the old one's address, so it can't key the cache
+    destroy_tracked_texture(*fov_mask);
+    *fov_mask = NULL;
+
+    // Software renderers pay per pixel for every blended triangle, so they fill the mask on the CPU
+    bool software = fov_backend == FOV_BACKEND_SOFTWARE;
+    if (fov_backend == FOV_BACKEND_AUTO) {
+        SDL_RendererInfo info;
+        software = SDL_GetRendererInfo(renderer, &info) == 0 && (info.flags & SDL_RENDERER_SOFTWARE);
+    }
+
+    if (software) {
+        fov_mask_scale = fov_soft_scale;
+        *fov_mask = create_tracked_texture(renderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_STREAMING,
+                                           (w + fov_mask_scale - 1) / fov_mask_scale, (h + fov_mask_scale - 1) / fov_mask_scale, "fov mask");
+    } else {
+        fov_mask_scale = 0;
+        *fov_mask = create_tracked_texture(renderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET, w, h, "fov mask");
     }
-    *fov_mask = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET, w, h);
     if (!*fov_mask) {
         printf("Failed to create FOV mask texture: %s\n", SDL_GetError());
         return;
     }
     SDL_SetTextureBlendMode(*fov_mask, SDL_BLENDMODE_BLEND);
+#if SDL_VERSION_ATLEAST(2, 0, 12)
+    if (fov_mask_scale > 1) SDL_SetTextureScaleMode(*fov_mask, SDL_ScaleModeLinear);
+#endif
+}
+
+// Appends a triangle fan around (cx, cy) to the FOV geometry. Each ray gets an inner vertex where the
+// fade starts and an outer vertex at its hit distance, so the band between them ramps from clear to fog.
+static void append_fov_fan(SDL_Vertex* vertices, int* vertex_count, int* indices, int* index_count,
+                           float cx, float cy, const float* cos_a, const float* sin_a, const float* dist, int rays,
+                           float fade_start, float fade_end) {
+    SDL_Color clear = {128, 128, 128, 0};
+    int center = *vertex_count;
+    vertices[(*vertex_count)++] = (SDL_Vertex){{cx, cy}, clear, {0.0f, 0.0f}};
+
+    for (int i = 0; i < rays; i++) {
+        float inner = minf(dist[i], fade_start);
+        float fade = (dist[i] > fade_start) ? (dist[i] - fade_start) / (fade_end - fade_start) : 0.0f;
+        SDL_Color outer_color = {128, 128, 128, (Uint8)(FOV_GRAY_ALPHA * minf(fade, 1.0f))};
+        vertices[(*vertex_count)++] = (SDL_Vertex){{cx + cos_a[i] * inner, cy + sin_a[i] * inner}, clear, {0.0f, 0.0f}};
+        vertices[(*vertex_count)++] = (SDL_Vertex){{cx + cos_a[i] * dist[i], cy + sin_a[i] * dist[i]}, outer_color, {0.0f, 0.0f}};
+    }
+
+    for (int i = 0; i < rays - 1; i++) {
+        int inner0 = center + 1 + 2 * i, outer0 = inner0 + 1;
+        int inner1 = inner0 + 2, outer1 = inner1 + 1;
+        // Clear wedge from the player to the fade start
+        indices[(*index_count)++] = center;
+        indices[(*index_count)++] = inner0;
+        indices[(*index_count)++] = inner1;
+        // Fade band from the fade start to the hit distance
+        indices[(*index_count)++] = inner0;
+        indices[(*index_count)++] = outer0;
+        indices[(*index_count)++] = outer1;
+        indices[(*index_count)++] = inner0;
+        indices[(*index_count)++] = outer1;
+        indices[(*index_count)++] = inner1;
+    }
 }
 
-void render_fov(SDL_Renderer* renderer, Player* player, Camera* camera, World* world, SDL_Texture* fov_mask) {
+static void draw_fov_mask(SDL_Renderer* renderer, const FovPolygons* fov, float player_screen_x, float player_screen_y, SDL_Texture* fov_mask);
+
+// Draws the FOV mask for the given polygons onto the screen, centred on the (interpolated) player.
+// The mask is only redrawn when the polygons or the player centre changed; when just the camera
+// moved, the cached mask is shifted, using its FOV_MASK_MARGIN border.
+void render_fov(SDL_Renderer* renderer, const FovPolygons* fov, Player* player, Camera* camera, SDL_Texture* fov_mask) {
     if (!renderer || !fov_mask) {
         printf("Error: Null renderer or FOV mask in render_fov\n");
         return;
     }
 
+    float player_x = player->x + player->w / 2.0f;
+    float player_y = player->y + player->h / 2.0f;
+    Uint32 hash = fov->hash;
+    hash = hash_bytes(hash, &player_x, sizeof(player_x));
+    hash = hash_bytes(hash, &player_y, sizeof(player_y));
+
+    int shift_x = (int)camera->x - (int)fov_cache_camera_x;
+    int shift_y = (int)camera->y - (int)fov_cache_camera_y;
+    int scale = fov_mask_scale > 0 ? fov_mask_scale : 1;
+    bool dirty = !fov_cache_valid || fov_cache_hash != hash ||
+                 fov_cache_sector_rays != fov->sector_rays || fov_cache_circle_rays != fov->circle_rays ||
+                 fov_cache_player_x != player_x || fov_cache_player_y != player_y ||
+                 absi(shift_x) > FOV_MASK_MARGIN || absi(shift_y) > FOV_MASK_MARGIN ||
+                 shift_x % scale != 0 || shift_y % scale != 0; // A downscaled mask can only shift by whole texels
+    if (dirty) {
+        draw_fov_mask(renderer, fov, player_x - camera->x + FOV_MASK_MARGIN, player_y - camera->y + FOV_MASK_MARGIN, fov_mask);
+        fov_cache_valid = true;
+        fov_cache_hash = hash;
+        fov_cache_sector_rays = fov->sector_rays;
+        fov_cache_circle_rays = fov->circle_rays;
+        fov_cache_player_x = player_x;
+        fov_cache_player_y = player_y;
+        fov_cache_camera_x = camera->x;
+        fov_cache_camera_y = camera->y;
+        shift_x = 0;
+        shift_y = 0;
+    }
+
+    SDL_Rect src_rect = {(FOV_MASK_MARGIN + shift_x) / scale, (FOV_MASK_MARGIN + shift_y) / scale,
+                         camera->w / scale, camera->h / scale};
+    SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
+    SDL_SetTextureAlphaMod(fov_mask, 255);
+    SDL_RenderCopy(renderer, fov_mask, &src_rect, NULL);
+}
+
+// Redraws the FOV mask texture with the polygons fanned out from the player's position in mask
+// coordinates (the mask has a margin around the screen)
+static void draw_fov_mask(SDL_Renderer* renderer, const FovPolygons* fov, float player_screen_x, float player_screen_y, SDL_Texture* fov_mask) {
+    const float* sector_cos = fov->sector_cos;
+    const float* sector_sin = fov->sector_sin;
+    const float* sector_dist = fov->sector_dist;
+    const float* circle_cos = fov->circle_cos;
+    const float* circle_sin = fov->circle_sin;
+    const float* circle_dist = fov->circle_dist;
+    int sector_rays = fov->sector_rays, circle_rays = fov->circle_rays;
+
+    // Software backend: rasterise both polygons straight into the streaming texture
+    if (fov_mask_scale > 0) {
+        void* pixels;
+        int pitch, mask_w, mask_h;
+        if (SDL_QueryTexture(fov_mask, NULL, NULL, &mask_w, &mask_h) != 0 ||
+            SDL_LockTexture(fov_mask, NULL, &pixels, &pitch) != 0) {
+            printf("Failed to lock FOV mask texture: %s\n", SDL_GetError());
+            return;
+        }
+        pitch /= (int)sizeof(Uint32);
+        clear_fog(pixels, pitch, mask_w, mask_h);
+        rasterize_fog_polygon(pixels, pitch, mask_w, mask_h, (float)fov_mask_scale, player_screen_x, player_screen_y,
+                              circle_cos, circle_sin, circle_dist, circle_rays, FOV_CIRCLE_TRANSITIONAL_RANGE, FOV_CIRCLE_R);
+        rasterize_fog_polygon(pixels, pitch, mask_w, mask_h, (float)fov_mask_scale, player_screen_x, player_screen_y,
+                              sector_cos, sector_sin, sector_dist, sector_rays, FOV_TRANSITIONAL_RANGE, FOV_RANGE);
+        SDL_UnlockTexture(fov_mask);
+        return;
+    }
+
     // Set the render target to the FOV mask texture
     SDL_SetRenderTarget(renderer, fov_mask);
     
@@ -136,52 +332,48 @@ void render_fov(SDL_Renderer* renderer, Player* player, Camera* camera, World* w
     SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_NONE);
     SDL_SetRenderDrawColor(renderer, 0, 0, 0, 0); // Fully transparent
 
-    // Calculate player position in world and screen coordinates
-    float player_x = player->x + player->w / 2.0f;
-    float player_y = player->y + player->h / 2.0f;
-    float player_screen_x = player_x - camera->x;
-    float player_screen_y = player_y - camera->y;
-
-    // Array to hold points for polygons (sector + circle, each with 64 rays + start/end points)
-    SDL_Point points[66]; // 64 rays + player start + player end
+    // Both fans go out in a single draw call. The circle comes first so the sector's clear wedge
+    // overwrites the circle's fade band where they overlap.
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+    static bool geometry_supported = true;
+#else
+    static bool geometry_supported = false;
+#endif
+    if (geometry_supported) {
+        static SDL_Vertex vertices[2 * (1 + 2 * FOV_MAX_RAYS)];
+        static int indices[2 * 9 * (FOV_MAX_RAYS - 1)];
+        int vertex_count = 0, index_count = 0;
+        append_fov_fan(vertices, &vertex_count, indices, &index_count, player_screen_x, player_screen_y,
+                       circle_cos, circle_sin, circle_dist, circle_rays, FOV_CIRCLE_TRANSITIONAL_RANGE, FOV_CIRCLE_R);
+        append_fov_fan(vertices, &vertex_count, indices, &index_count, player_screen_x, player_screen_y,
+                       sector_cos, sector_sin, sector_dist, sector_rays, FOV_TRANSITIONAL_RANGE, FOV_RANGE);
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+        if (SDL_RenderGeometry(renderer, NULL, vertices, vertex_count, indices, index_count) != 0) {
+            printf("SDL_RenderGeometry unsupported, falling back to scanline FOV: %s\n", SDL_GetError());
+            geometry_supported = false;
+        }
+#endif
+    }
 
-    // --- Sector Polygon (90-degree, 700 pixels) ---
-    int rays = 64;
-    float angle_rad = player->angle * (MA_PI / 180.0f);
-    float half_fov_rad = FOV_HALF_ANGLE * (MA_PI / 180.0f);
-    float angle_step = (2.0f * half_fov_rad) / (rays - 1);
+    // Fallback for renderers without geometry support: hard-edged scanline polygons
+    if (!geometry_supported) {
+        static SDL_Point points[FOV_MAX_RAYS + 2]; // Rays + player start + player end
+        points[0].x = (int)player_screen_x;
+        points[0].y = (int)player_screen_y;
+        for (int i = 0; i < sector_rays; i++) {
+            points[i + 1].x = (int)(player_screen_x + sector_cos[i] * sector_dist[i]);
+            points[i + 1].y = (int)(player_screen_y + sector_sin[i] * sector_dist[i]);
+        }
+        points[sector_rays + 1] = points[0];
+        SDL_RenderFillPolygon(renderer, points, sector_rays + 2);
 
-    points[0].x = (int)player_screen_x;
-    points[0].y = (int)player_screen_y;
-    for (int i = 0; i < rays; i++) {
-        float ray_angle = angle_rad - half_fov_rad + angle_step * i;
-        float cos_a = my_cosf(ray_angle);
-        float sin_a = my_sinf(ray_angle);
-        float dist = get_visibility_distance(player_x, player_y, cos_a, sin_a, world);
-        if (dist > FOV_RANGE) dist = FOV_RANGE;
-        points[i + 1].x = (int)(player_screen_x + cos_a * dist);
-        points[i + 1].y = (int)(player_screen_y + sin_a * dist);
-    }
-    points[rays + 1].x = points[0].x;
-    points[rays + 1].y = points[0].y;
-    SDL_RenderFillPolygon(renderer, points, rays + 2);
-
-    // --- Circle Polygon (360-degree, 64 pixels) ---
-    float circle_angle_step = (2.0f * MA_PI) / (rays - 1);
-    points[0].x = (int)player_screen_x;
-    points[0].y = (int)player_screen_y;
-    for (int i = 0; i < rays; i++) {
-        float ray_angle = circle_angle_step * i;
-        float cos_a = my_cosf(ray_angle);
-        float sin_a = my_sinf(ray_angle);
-        float dist = get_visibility_distance(player_x, player_y, cos_a, sin_a, world);
-        if (dist > FOV_CIRCLE_R) dist = FOV_CIRCLE_R;
-        points[i + 1].x = (int)(player_screen_x + cos_a * dist);
-        points[i + 1].y = (int)(player_screen_y + sin_a * dist);
+        for (int i = 0; i < circle_rays; i++) {
+            points[i + 1].x = (int)(player_screen_x + circle_cos[i] * circle_dist[i]);
+            points[i + 1].y = (int)(player_screen_y + circle_sin[i] * circle_dist[i]);
+        }
+        points[circle_rays + 1] = points[0];
+        SDL_RenderFillPolygon(renderer, points, circle_rays + 2);
     }
-    points[rays + 1].x = points[0].x;
-    points[rays + 1].y = points[0].y;
-    SDL_RenderFillPolygon(renderer, points, rays + 2);
 
     // Restore original blend mode and render target
     SDL_SetRenderDrawBlendMode(renderer, current_blend_mode);
@@ -246,13 +438,17 @@ bool is_in_fov(float x, float y, Player* player, World* world, float* alpha) {
     return true;
 }
 
-// Modified render() function in render.c (only the relevant parts are shown; replace accordingly)
-
-void render(SDL_Renderer* renderer, Player* player, Camera* camera, World* world, Bullet* bullets, Enemy* enemies, TTF_Font* font, Console* console, GameState* game_state, Menu* menu) {
+// Draws one frame from a render snapshot. player is the snapshot's player interpolated by alpha,
+// the share of a tick passed since the snapshot, and the camera is centred on it; everything
+// else moving is interpolated by alpha as well. Reads nothing the simulation writes, so it can
+// run while the next tick is simulated. frame_dt is the real time since the last frame, in seconds,
+// for what is animated in wall-clock time rather than simulation time.
+void render(SDL_Renderer* renderer, const RenderSnapshot* snap, Player* player, float alpha, float frame_dt, Camera* camera, World* world, Console* console, GameState* game_state, Menu* menu) {
     if (!renderer) {
         printf("Error: Null renderer in render\n");
         return;
     }
+    note_stack_depth(STACK_RENDER);
 
     // Check renderer size and recreate fov_mask if necessary
     static int last_w = 0, last_h = 0;
@@ -265,120 +461,98 @@ void render(SDL_Renderer* renderer, Player* player, Camera* camera, World* world
     if (renderer_w != last_w || renderer_h != last_h || !fov_mask) {
         last_w = renderer_w;
         last_h = renderer_h;
-        init_fov_mask(renderer, &fov_mask, renderer_w, renderer_h);
+        init_fov_mask(renderer, &fov_mask, renderer_w + 2 * FOV_MASK_MARGIN, renderer_h + 2 * FOV_MASK_MARGIN);
     }
 
+    PROFILE_BEGIN(PROFILE_RENDER_MAP);
     SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
     SDL_RenderClear(renderer);
 
-    // Render background
-    SDL_Rect bg_dst = {-(int)camera->x, -(int)camera->y, WORLD_W, WORLD_H};
-    SDL_RenderCopy(renderer, world->background, NULL, &bg_dst);
+    // Render background and walls, baked into chunk textures. Only what overlaps the view is drawn,
+    // so the number of draw calls follows the viewport size rather than the world size.
+    render_map_chunks(renderer, world, camera);
+    PROFILE_END(PROFILE_RENDER_MAP);
 
-    // Render walls
-    for (int i = 0; i < world->wall_count; i++) {
-        if (world->walls[i].type != WALL_NONE) {
-            SDL_Rect wall_rect = {
-                (int)(world->walls[i].x - camera->x),
-                (int)(world->walls[i].y - camera->y),
-                (int)world->walls[i].w,
-                (int)world->walls[i].h
-            };
-            SDL_SetRenderDrawColor(renderer, 128, 128, 128, 255);
-            if (world->walls[i].type == WALL_BULLETPROOF) {
-                SDL_SetRenderDrawColor(renderer, 100, 100, 100, 255);
-            } else if (world->walls[i].type == WALL_OPAQUE) {
-                SDL_SetRenderDrawColor(renderer, 150, 150, 150, 255);
-            }
-            SDL_SetTextureAlphaMod(world->walls[i].texture, 255);
-            SDL_RenderCopy(renderer, world->walls[i].texture, NULL, &wall_rect);
-        }
-    }
+    // Flags, the player and enemies share the sprite atlas and go out as one batch
+    PROFILE_BEGIN(PROFILE_RENDER_SPRITES);
+    static SpriteBatch batch;
+    begin_sprite_batch(&batch, renderer, &world->atlas);
 
     // Render flags
     for (int i = 0; i < world->flag_count; i++) {
-        if (world->flags[i].active) {
-            SDL_Rect flag_rect = {
-                (int)(world->flags[i].x - camera->x),
-                (int)(world->flags[i].y - camera->y),
-                (int)world->flags[i].w,
-                (int)world->flags[i].h
-            };
-            SDL_SetTextureAlphaMod(world->flags[i].texture, 255);
-            SDL_RenderCopy(renderer, world->flags[i].texture, NULL, &flag_rect);
+        if (world->flags[i].active &&
+            check_collision(world->flags[i].x, world->flags[i].y, world->flags[i].w, world->flags[i].h,
+                            camera->x, camera->y, camera->w, camera->h)) {
+            add_sprite(&batch, SPRITE_FLAG, world->flags[i].texture, world->flags[i].x - camera->x, world->flags[i].y - camera->y,
+                       world->flags[i].w, world->flags[i].h, 0.0f, 255);
         }
     }
 
     // Render player (always visible)
-    SDL_Rect player_dst_rect = {(int)(player->x - camera->x), (int)(player->y - camera->y),
-                                (int)player->w, (int)player->h};
-    SDL_Point pcenter = {(int)player->w / 2, (int)player->h / 2};
-    SDL_RenderCopyEx(renderer, player->texture, NULL, &player_dst_rect, player->angle, &pcenter, SDL_FLIP_NONE);
-
-    // Render enemies with FOV and transitional alpha
-    for (int i = 0; i < MAX_ENEMIES; i++) {
-        if (enemies[i].active) {
-            float alpha;
-            float enemy_center_x = enemies[i].x + enemies[i].w / 2;
-            float enemy_center_y = enemies[i].y + enemies[i].h / 2;
-            if (!is_in_fov(enemy_center_x, enemy_center_y, player, world, &alpha)) {
-                continue;
-            }
-            SDL_Rect enemy_dst_rect = {
-                (int)(enemies[i].x - camera->x),
-                (int)(enemies[i].y - camera->y),
-                (int)enemies[i].w,
-                (int)enemies[i].h
-            };
-            SDL_Point center = {(int)(enemies[i].w / 2), (int)(enemies[i].h / 2)};
-            SDL_SetTextureAlphaMod(enemies[i].texture, (Uint8)alpha);
-            SDL_RenderCopyEx(renderer, enemies[i].texture, NULL, &enemy_dst_rect, enemies[i].angle, &center, SDL_FLIP_NONE);
-            SDL_SetTextureAlphaMod(enemies[i].texture, 255);
-        }
+    add_sprite(&batch, SPRITE_PLAYER, player->texture, player->x - camera->x, player->y - camera->y,
+               player->w, player->h, player->angle, 255);
+
+    // Render enemies the snapshot found in the FOV, with their transitional alpha
+    for (int i = 0; i < snap->enemy_count; i++) {
+        const EnemyView* enemy = &snap->enemies[i];
+        if (enemy->alpha == 0) continue;
+        float x = enemy->prev_x + (enemy->x - enemy->prev_x) * alpha;
+        float y = enemy->prev_y + (enemy->y - enemy->prev_y) * alpha;
+        if (!check_collision(x, y, enemy->w, enemy->h, camera->x, camera->y, camera->w, camera->h)) continue;
+        add_sprite(&batch, SPRITE_ENEMY, enemy->texture, x - camera->x, y - camera->y,
+                   enemy->w, enemy->h, lerp_angle(enemy->prev_angle, enemy->angle, alpha), enemy->alpha);
     }
-
-    // Render bullets with FOV
-    for (int i = 0; i < MAX_BULLETS; i++) {
-        if (bullets[i].active) {
-            float alpha = 255;
-            //if (!is_in_fov(bullets[i].x, bullets[i].y, player, world, &alpha)) continue;
-            SDL_Rect bullet_rect = {(int)(bullets[i].x - camera->x),
-                                    (int)(bullets[i].y - camera->y), 5, 5};
-            SDL_SetRenderDrawColor(renderer, 255, 255, 0, (Uint8)alpha);
-            SDL_RenderFillRect(renderer, &bullet_rect);
-        }
+    flush_sprite_batch(&batch);
+    PROFILE_END(PROFILE_RENDER_SPRITES);
+
+    // Render bullets, all in one call
+    PROFILE_BEGIN(PROFILE_RENDER_BULLETS);
+    static SDL_Rect bullet_rects[MAX_BULLETS];
+    int bullet_count = 0;
+    for (int i = 0; i < snap->bullet_count; i++) {
+        const BulletView* bullet = &snap->bullets[i];
+        float x = bullet->prev_x + (bullet->x - bullet->prev_x) * alpha;
+        float y = bullet->prev_y + (bullet->y - bullet->prev_y) * alpha;
+        if (!check_collision(x, y, 5, 5, camera->x, camera->y, camera->w, camera->h)) continue;
+        bullet_rects[bullet_count++] = (SDL_Rect){(int)(x - camera->x), (int)(y - camera->y), 5, 5};
     }
+    SDL_SetRenderDrawColor(renderer, 255, 255, 0, 255);
+    SDL_RenderFillRects(renderer, bullet_rects, bullet_count);
+    PROFILE_END(PROFILE_RENDER_BULLETS);
 
     // Render FOV mask
-    render_fov(renderer, player, camera, world, fov_mask);
-    SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
-    SDL_SetTextureAlphaMod(fov_mask, 255);
-    SDL_RenderCopy(renderer, fov_mask, NULL, NULL);
+    PROFILE_BEGIN(PROFILE_RENDER_FOV);
+    render_fov(renderer, &snap->fov, player, camera, fov_mask);
+    PROFILE_END(PROFILE_RENDER_FOV);
 
-    static SDL_Texture* fps_texture = NULL;
+    // FPS counter, formatted only when the shown value changes
+    PROFILE_BEGIN(PROFILE_RENDER_HUD);
+    static char fps_text[16] = "";
     static float last_fps = -1.0f;
-    if (font && absf(world->fps - last_fps) > 1.0f) {
+    if (absf(world->fps - last_fps) > 1.0f) {
         last_fps = world->fps;
-        if (fps_texture) SDL_DestroyTexture(fps_texture);
-        char fps_text[16];
         snprintf(fps_text, sizeof(fps_text), "FPS: %.1f", world->fps);
-        SDL_Color white = {255, 255, 255, 255};
-        SDL_Surface* text_surface = TTF_RenderText_Solid(font, fps_text, white);
-        if (text_surface) {
-            fps_texture = SDL_CreateTextureFromSurface(renderer, text_surface);
-            SDL_FreeSurface(text_surface);
-        }
-    }
-    if (fps_texture) {
-        int text_w, text_h;
-        SDL_QueryTexture(fps_texture, NULL, NULL, &text_w, &text_h);
-        SDL_Rect text_rect = {10, 10, text_w, text_h};
-        SDL_RenderCopy(renderer, fps_texture, NULL, &text_rect);
     }
-
-    render_console(renderer, console, font);
-
-    if (game_state->minimap) render_minimap(renderer, player, bullets, camera, world, enemies);
+    static TextBatch hud_batch;
+    begin_text_batch(&hud_batch, renderer, &world->glyphs);
+    add_text(&hud_batch, fps_text, 10, 10, (SDL_Color){255, 255, 255, 255});
+    add_text(&hud_batch, snap->hud_text, 10, 10 + world->glyphs.line_height, (SDL_Color){255, 255, 255, 255});
+    flush_text_batch(&hud_batch);
+    PROFILE_END(PROFILE_RENDER_HUD);
+
+    PROFILE_BEGIN(PROFILE_RENDER_CONSOLE);
+    render_console(renderer, console, &world->glyphs, frame_dt);
+    PROFILE_END(PROFILE_RENDER_CONSOLE);
+
+    PROFILE_BEGIN(PROFILE_RENDER_MINIMAP);
+    if (game_state->minimap) render_minimap(renderer, snap, player, camera, world);
+    PROFILE_END(PROFILE_RENDER_MINIMAP);
+    PROFILE_BEGIN(PROFILE_RENDER_MENU);
     render_menu(renderer, menu);
+    PROFILE_END(PROFILE_RENDER_MENU);
+    render_profiler(renderer, &world->glyphs);
+
+    PROFILE_BEGIN(PROFILE_PRESENT);
     SDL_RenderPresent(renderer);
+    PROFILE_END(PROFILE_PRESENT);
 }
@@ -0,0 +1,65 @@
+#include "snapshot.h"
+#include "utils.h"
+#include "render.h"
+#include "visibility.h"
+#include "profiler.h"
+
+// Copies what the renderer needs out of the simulation state after a tick. Enemy visibility and
+// the FOV polygons are worked out here, on the simulation side. previous is the last snapshot
+// built (or NULL); its polygons are reused when the player and map did not change.
+void build_render_snapshot(RenderSnapshot* snap, const RenderSnapshot* previous, Player* player, World* world, Enemy* enemies, Bullet* bullets) {
+    snap->sequence = previous ? previous->sequence + 1 : 0;
+    snap->time = SDL_GetPerformanceCounter();
+    snap->dt = fixed_dt;
+    snap->player = *player;
+
+    snap->enemy_count = 0;
+    for (int i = 0; i < MAX_ENEMIES; i++) {
+        Enemy* enemy = &enemies[i];
+        if (!enemy->active) continue;
+        float alpha;
+        if (!is_in_fov(enemy->x + enemy->w / 2, enemy->y + enemy->h / 2, player, world, &alpha)) alpha = 0.0f;
+        snap->enemies[snap->enemy_count++] = (EnemyView){
+            enemy->x, enemy->y, enemy->prev_x, enemy->prev_y, enemy->w, enemy->h,
+            enemy->angle, enemy->prev_angle, (Uint8)alpha, enemy->in_cover, enemy->texture
+        };
+    }
+
+    snap->bullet_count = 0;
+    for (int i = 0; i < MAX_BULLETS; i++) {
+        if (!bullets[i].active) continue;
+        snap->bullets[snap->bullet_count++] = (BulletView){bullets[i].x, bullets[i].y, bullets[i].prev_x, bullets[i].prev_y};
+    }
+
+    build_fov_polygons(&snap->fov, previous ? &previous->fov : NULL, player, world);
+    snprintf(snap->hud_text, sizeof(snap->hud_text), "Sim: %d Hz, %d enemies", (int)(1.0f / fixed_dt + 0.5f), snap->enemy_count);
+}
+
+void init_snapshot_buffer(SnapshotBuffer* buffer) {
+    memset(buffer->slots, 0, sizeof(buffer->slots));
+    buffer->back = 0;
+    buffer->latest = -1;
+    buffer->front = 2;
+    SDL_AtomicSet(&buffer->ready, 1);
+}
+
+// Builds a snapshot into the back slot and makes it the ready one. The slot it replaces becomes the
+// new back slot, so the simulation never waits for the renderer.
+void publish_render_snapshot(SnapshotBuffer* buffer, Player* player, World* world, Enemy* enemies, Bullet* bullets) {
+    // The last published slot is ready or being drawn, never the back slot, so it can be read here
+    PROFILE_BEGIN(PROFILE_SNAPSHOT);
+    const RenderSnapshot* previous = buffer->latest >= 0 ? &buffer->slots[buffer->latest] : NULL;
+    build_render_snapshot(&buffer->slots[buffer->back], previous, player, world, enemies, bullets);
+    PROFILE_END(PROFILE_SNAPSHOT);
+    buffer->latest = buffer->back;
+    buffer->back = SDL_AtomicSet(&buffer->ready, buffer->back | SNAPSHOT_FRESH) & ~SNAPSHOT_FRESH;
+}
+
+// Returns the newest published snapshot, swapping it in for the slot drawn last if there is a new
+// one. The returned snapshot stays untouched until the next call, so the renderer never waits either.
+const RenderSnapshot* acquire_render_snapshot(SnapshotBuffer* buffer) {
+    if (SDL_AtomicGet(&buffer->ready) & SNAPSHOT_FRESH) {
+        buffer->front = SDL_AtomicSet(&buffer->ready, buffer->front) & ~SNAPSHOT_FRESH;
+    }
+    return &buffer->slots[buffer->front];
+}
@@ -0,0 +1,170 @@
+#include "sprites.h"
+#include "utils.h"
+#include "memtrack.h"
+
+// Loads every sprite image and packs them into one atlas texture with a shelf packer: images go
+// left to right in rows, tallest first, each row as tall as its first image. Returns false (and
+// leaves atlas->texture NULL) on failure, in which case batches draw the standalone textures.
+bool build_sprite_atlas(SpriteAtlas* atlas, SDL_Renderer* renderer, const char* const paths[SPRITE_COUNT]) {
+    if (!atlas || !renderer) {
+        printf("Error: Null atlas or renderer in build_sprite_atlas\n");
+        return false;
+    }
+    atlas->texture = NULL;
+
+    SDL_Surface* images[SPRITE_COUNT] = {NULL};
+    int order[SPRITE_COUNT];
+    bool ok = true;
+    for (int i = 0; i < SPRITE_COUNT && ok; i++) {
+        SDL_Surface* loaded = IMG_Load(paths[i]);
+        if (!loaded) {
+            printf("Failed to load image %s: %s\n", paths[i], IMG_GetError());
+            ok = false;
+            break;
+        }
+        images[i] = SDL_ConvertSurfaceFormat(loaded, SDL_PIXELFORMAT_RGBA32, 0);
+        SDL_FreeSurface(loaded);
+        if (!images[i] || images[i]->w + 2 * SPRITE_ATLAS_PADDING > SPRITE_ATLAS_W) {
+            printf("Failed to prepare atlas image %s\n", paths[i]);
+            ok = false;
+        }
+        order[i] = i;
+    }
+
+    if (ok) {
+        // Sort by height, tallest first (insertion sort; there are only a handful of sprites)
+        for (int i = 1; i < SPRITE_COUNT; i++) {
+            int id = order[i], j = i - 1;
+            while (j >= 0 && images[order[j]]->h < images[id]->h) {
+                order[j + 1] = order[j];
+                j--;
+            }
+            order[j + 1] = id;
+        }
+
+        int x = 0, y = 0, row_h = 0;
+        for (int i = 0; i < SPRITE_COUNT; i++) {
+            SDL_Surface* image = images[order[i]];
+            int w = image->w + 2 * SPRITE_ATLAS_PADDING, h = image->h + 2 * SPRITE_ATLAS_PADDING;
+            if (x + w > SPRITE_ATLAS_W) {
+                x = 0;
+                y += row_h;
+                row_h = 0;
+            }
+            atlas->regions[order[i]] = (SDL_Rect){x + SPRITE_ATLAS_PADDING, y + SPRITE_ATLAS_PADDING, image->w, image->h};
+            if (h > row_h) row_h = h;
+            x += w;
+        }
+        atlas->w = SPRITE_ATLAS_W;
+        atlas->h = y + row_h;
+
+        SDL_Surface* sheet = SDL_CreateRGBSurfaceWithFormat(0, atlas->w, atlas->h, 32, SDL_PIXELFORMAT_RGBA32);
+        if (!sheet) {
+            printf("Failed to create atlas surface: %s\n", SDL_GetError());
+            ok = false;
+        } else {
+            SDL_FillRect(sheet, NULL, 0); // Transparent padding
+            for (int i = 0; i < SPRITE_COUNT; i++) {
+                SDL_SetSurfaceBlendMode(images[i], SDL_BLENDMODE_NONE); // Copy alpha as is
+                SDL_BlitSurface(images[i], NULL, sheet, &atlas->regions[i]);
+            }
+            atlas->texture = create_tracked_texture_from_surface(renderer, sheet, "sprite atlas");
+            SDL_FreeSurface(sheet);
+            if (!atlas->texture) {
+                printf("Failed to create atlas texture: %s\n", SDL_GetError());
+                ok = false;
+            } else {
+                SDL_SetTextureBlendMode(atlas->texture, SDL_BLENDMODE_BLEND);
+            }
+        }
+    }
+
+    for (int i = 0; i < SPRITE_COUNT; i++) {
+        if (images[i]) SDL_FreeSurface(images[i]);
+    }
+    return ok;
+}
+
+void free_sprite_atlas(SpriteAtlas* atlas) {
+    destroy_tracked_texture(atlas->texture);
+    atlas->texture = NULL;
+}
+
+void begin_sprite_batch(SpriteBatch* batch, SDL_Renderer* renderer, SpriteAtlas* atlas) {
+    batch->renderer = renderer;
+    batch->atlas = atlas;
+    batch->count = 0;
+}
+
+// Queues a sprite. texture is the sprite's standalone texture, drawn instead of the atlas region
+// when geometry batching is unavailable. A full batch is flushed first.
+void add_sprite(SpriteBatch* batch, SpriteId id, SDL_Texture* texture, float x, float y, float w, float h, float angle, Uint8 alpha) {
+    if (batch->count >= SPRITE_BATCH_MAX) flush_sprite_batch(batch);
+    batch->sprites[batch->count++] = (SpriteInstance){id, texture, {x, y, w, h}, angle, alpha};
+}
+
+// Draws the queued sprites in order. With geometry support the quads are rotated on the CPU,
+// carry their alpha in the vertex colours and go out as one SDL_RenderGeometry call on the atlas.
+void flush_sprite_batch(SpriteBatch* batch) {
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+    static bool geometry_supported = true;
+#else
+    static bool geometry_supported = false;
+#endif
+    if (batch->count == 0) return;
+
+    if (geometry_supported && batch->atlas && batch->atlas->texture) {
+        static SDL_Vertex vertices[4 * SPRITE_BATCH_MAX];
+        static int indices[6 * SPRITE_BATCH_MAX];
+        SpriteAtlas* atlas = batch->atlas;
+        float inv_w = 1.0f / atlas->w, inv_h = 1.0f / atlas->h;
+        const float corner_x[4] = {-0.5f, 0.5f, 0.5f, -0.5f};
+        const float corner_y[4] = {-0.5f, -0.5f, 0.5f, 0.5f};
+
+        for (int i = 0; i < batch->count; i++) {
+            SpriteInstance* s = &batch->sprites[i];
+            SDL_Rect* region = &atlas->regions[s->id];
+            float rad = s->angle * (MA_PI / 180.0f);
+            float c = (s->angle == 0.0f) ? 1.0f : my_cosf(rad);
+            float sn = (s->angle == 0.0f) ? 0.0f : my_sinf(rad);
+            float cx = s->dst.x + s->dst.w / 2.0f, cy = s->dst.y + s->dst.h / 2.0f;
+            float u0 = region->x * inv_w, v0 = region->y * inv_h;
+            float u1 = (region->x + region->w) * inv_w, v1 = (region->y + region->h) * inv_h;
+            SDL_Color color = {255, 255, 255, s->alpha};
+
+            for (int k = 0; k < 4; k++) {
+                // Rotate the corner offset clockwise on screen, as SDL_RenderCopyEx does
+                float ox = corner_x[k] * s->dst.w, oy = corner_y[k] * s->dst.h;
+                SDL_Vertex* v = &vertices[4 * i + k];
+                v->position.x = cx + ox * c - oy * sn;
+                v->position.y = cy + ox * sn + oy * c;
+                v->color = color;
+                v->tex_coord.x = (k == 1 || k == 2) ? u1 : u0;
+                v->tex_coord.y = (k >= 2) ? v1 : v0;
+            }
+            int* idx = &indices[6 * i];
+            idx[0] = 4 * i; idx[1] = 4 * i + 1; idx[2] = 4 * i + 2;
+            idx[3] = 4 * i; idx[4] = 4 * i + 2; idx[5] = 4 * i + 3;
+        }
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+        if (SDL_RenderGeometry(batch->renderer, atlas->texture, vertices, 4 * batch->count, indices, 6 * batch->count) == 0) {
+            batch->count = 0;
+            return;
+        }
+        printf("SDL_RenderGeometry unsupported, falling back to per-sprite copies: %s\n", SDL_GetError());
+        geometry_supported = false;
+#endif
+    }
+
+    // Fallback: one copy per sprite from its standalone texture
+    for (int i = 0; i < batch->count; i++) {
+        SpriteInstance* s = &batch->sprites[i];
+        if (!s->texture) continue;
+        SDL_Rect dst = {(int)s->dst.x, (int)s->dst.y, (int)s->dst.w, (int)s->dst.h};
+        SDL_Point center = {(int)(s->dst.w / 2), (int)(s->dst.h / 2)};
+        SDL_SetTextureAlphaMod(s->texture, s->alpha);
+        SDL_RenderCopyEx(batch->renderer, s->texture, NULL, &dst, s->angle, &center, SDL_FLIP_NONE);
+        SDL_SetTextureAlphaMod(s->texture, 255);
+    }
+    batch->count = 0;
+}
@@ -0,0 +1,180 @@
+#include "text.h"
+#include "utils.h"
+#include "memtrack.h"
+
+// Maps a character to its glyph index, drawing anything outside printable ASCII as '?'
+static int glyph_index(char c) {
+    unsigned char u = (unsigned char)c;
+    return (u >= GLYPH_FIRST && u < GLYPH_END) ? u - GLYPH_FIRST : '?' - GLYPH_FIRST;
+}
+
+// Rasterises every printable ASCII glyph of the font once, white on transparent, and packs them
+// into one atlas texture in rows. Each glyph is rendered as a one character string so its surface
+// is a full line tall with the glyph already sitting on the baseline, which keeps layout down to
+// adding advances. Returns false (and leaves atlas->texture NULL) on failure; text is then not drawn.
+bool build_glyph_atlas(GlyphAtlas* atlas, SDL_Renderer* renderer, TTF_Font* font) {
+    if (!atlas || !renderer || !font) {
+        printf("Error: Null atlas, renderer or font in build_glyph_atlas\n");
+        return false;
+    }
+    atlas->texture = NULL;
+    atlas->line_height = TTF_FontHeight(font);
+
+    SDL_Surface* images[GLYPH_COUNT] = {NULL};
+    SDL_Color white = {255, 255, 255, 255};
+    int x = 0, y = 0, row_h = atlas->line_height + 2 * GLYPH_ATLAS_PADDING;
+    for (int i = 0; i < GLYPH_COUNT; i++) {
+        char text[2] = {(char)(GLYPH_FIRST + i), '\0'};
+        int advance = 0;
+        SDL_Surface* rendered = TTF_RenderText_Blended(font, text, white);
+        if (rendered) {
+            images[i] = SDL_ConvertSurfaceFormat(rendered, SDL_PIXELFORMAT_RGBA32, 0);
+            SDL_FreeSurface(rendered);
+        }
+        if (TTF_GlyphMetrics(font, (Uint16)(GLYPH_FIRST + i), NULL, NULL, NULL, NULL, &advance) != 0 && images[i]) {
+            advance = images[i]->w;
+        }
+        atlas->advance[i] = advance;
+        atlas->regions[i] = (SDL_Rect){0, 0, 0, 0};
+        if (!images[i]) continue; // Blank or missing glyph: advance only
+
+        int w = images[i]->w + 2 * GLYPH_ATLAS_PADDING;
+        if (w > GLYPH_ATLAS_W) {
+            SDL_FreeSurface(images[i]);
+            images[i] = NULL;
+            continue;
+        }
+        if (x + w > GLYPH_ATLAS_W) {
+            x = 0;
+            y += row_h;
+        }
+        atlas->regions[i] = (SDL_Rect){x + GLYPH_ATLAS_PADDING, y + GLYPH_ATLAS_PADDING, images[i]->w, images[i]->h};
+        x += w;
+    }
+    atlas->w = GLYPH_ATLAS_W;
+    atlas->h = y + row_h;
+
+    bool ok = true;
+    SDL_Surface* sheet = SDL_CreateRGBSurfaceWithFormat(0, atlas->w, atlas->h, 32, SDL_PIXELFORMAT_RGBA32);
+    if (!sheet) {
+        printf("Failed to create glyph atlas surface: %s\n", SDL_GetError());
+        ok = false;
+    } else {
+        SDL_FillRect(sheet, NULL, 0);
+        for (int i = 0; i < GLYPH_COUNT; i++) {
+            if (!images[i]) continue;
+            SDL_SetSurfaceBlendMode(images[i], SDL_BLENDMODE_NONE); // Copy alpha as is
+            SDL_BlitSurface(images[i], NULL, sheet, &atlas->regions[i]);
+        }
+        atlas->texture = create_tracked_texture_from_surface(renderer, sheet, "glyph atlas");
+        SDL_FreeSurface(sheet);
+        if (!atlas->texture) {
+            printf("Failed to create glyph atlas texture: %s\n", SDL_GetError());
+            ok = false;
+        } else {
+            SDL_SetTextureBlendMode(atlas->texture, SDL_BLENDMODE_BLEND);
+        }
+    }
+
+    for (int i = 0; i < GLYPH_COUNT; i++) {
+        if (images[i]) SDL_FreeSurface(images[i]);
+    }
+    return ok;
+}
+
+void free_glyph_atlas(GlyphAtlas* atlas) {
+    destroy_tracked_texture(atlas->texture);
+    atlas->texture = NULL;
+}
+
+// Returns the width of text in pixels from the cached glyph metrics, without touching the font
+int measure_text(const GlyphAtlas* atlas, const char* text) {
+    int pen = 0, width = 0;
+    for (const char* c = text; *c; c++) {
+        int g = glyph_index(*c);
+        if (pen + atlas->regions[g].w > width) width = pen + atlas->regions[g].w;
+        pen += atlas->advance[g];
+    }
+    return (pen > width) ? pen : width;
+}
+
+void begin_text_batch(TextBatch* batch, SDL_Renderer* renderer, GlyphAtlas* atlas) {
+    batch->renderer = renderer;
+    batch->atlas = atlas;
+    batch->count = 0;
+}
+
+// Lays text out from (x, y), its top left corner, and queues one quad per visible glyph.
+// A full batch is flushed first.
+void add_text(TextBatch* batch, const char* text, int x, int y, SDL_Color color) {
+    GlyphAtlas* atlas = batch->atlas;
+    if (!atlas || !atlas->texture) return;
+    int pen = x;
+    for (const char* c = text; *c; c++) {
+        int g = glyph_index(*c);
+        if (atlas->regions[g].w > 0) {
+            if (batch->count >= TEXT_BATCH_MAX) flush_text_batch(batch);
+            batch->glyphs[batch->count++] = (GlyphInstance){g, (float)pen, (float)y, color};
+        }
+        pen += atlas->advance[g];
+    }
+}
+
+// Draws the queued glyphs. With geometry support they go out as one SDL_RenderGeometry call on
+// the atlas, tinted by their vertex colours; otherwise each glyph is copied from the atlas with
+// a colour mod, which still needs no per-string textures.
+void flush_text_batch(TextBatch* batch) {
+    GlyphAtlas* atlas = batch->atlas;
+    if (batch->count == 0 || !atlas || !atlas->texture) {
+        batch->count = 0;
+        return;
+    }
+
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+    static bool geometry_supported = true;
+    if (geometry_supported) {
+        static SDL_Vertex vertices[4 * TEXT_BATCH_MAX];
+        static int indices[6 * TEXT_BATCH_MAX];
+        float inv_w = 1.0f / atlas->w, inv_h = 1.0f / atlas->h;
+
+        for (int i = 0; i < batch->count; i++) {
+            GlyphInstance* g = &batch->glyphs[i];
+            SDL_Rect* region = &atlas->regions[g->glyph];
+            float x0 = g->x, y0 = g->y, x1 = g->x + region->w, y1 = g->y + region->h;
+            float u0 = region->x * inv_w, v0 = region->y * inv_h;
+            float u1 = (region->x + region->w) * inv_w, v1 = (region->y + region->h) * inv_h;
+            SDL_Vertex* v = &vertices[4 * i];
+            v[0] = (SDL_Vertex){{x0, y0}, g->color, {u0, v0}};
+            v[1] = (SDL_Vertex){{x1, y0}, g->color, {u1, v0}};
+            v[2] = (SDL_Vertex){{x1, y1}, g->color, {u1, v1}};
+            v[3] = (SDL_Vertex){{x0, y1}, g->color, {u0, v1}};
+            int* idx = &indices[6 * i];
+            idx[0] = 4 * i; idx[1] = 4 * i + 1; idx[2] = 4 * i + 2;
+            idx[3] = 4 * i; idx[4] = 4 * i + 2; idx[5] = 4 * i + 3;
+        }
+        if (SDL_RenderGeometry(batch->renderer, atlas->texture, vertices, 4 * batch->count, indices, 6 * batch->count) == 0) {
+            batch->count = 0;
+            return;
+        }
+        printf("SDL_RenderGeometry unsupported, falling back to per-glyph copies: %s\n", SDL_GetError());
+        geometry_supported = false;
+    }
+#endif
+
+    // Fallback: one copy per glyph, changing the colour mod only between differently tinted runs
+    SDL_Color current = {255, 255, 255, 255};
+    for (int i = 0; i < batch->count; i++) {
+        GlyphInstance* g = &batch->glyphs[i];
+        if (g->color.r != current.r || g->color.g != current.g || g->color.b != current.b || g->color.a != current.a) {
+            current = g->color;
+            SDL_SetTextureColorMod(atlas->texture, current.r, current.g, current.b);
+            SDL_SetTextureAlphaMod(atlas->texture, current.a);
+        }
+        SDL_Rect* region = &atlas->regions[g->glyph];
+        SDL_Rect dst = {(int)g->x, (int)g->y, region->w, region->h};
+        SDL_RenderCopy(batch->renderer, atlas->texture, region, &dst);
+    }
+    SDL_SetTextureColorMod(atlas->texture, 255, 255, 255);
+    SDL_SetTextureAlphaMod(atlas->texture, 255);
+    batch->count = 0;
+}
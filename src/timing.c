@@ -0,0 +1,116 @@
+#include "timing.h"
+#include "utils.h"
+
+static const char* timing_names[TIMING_METRIC_COUNT] = {
+    [TIMING_FRAME] = "frame",
+    [TIMING_TICK] = "tick",
+    [TIMING_RENDER] = "render"
+};
+
+// Each metric is recorded by one thread only: frames and rendering by the main thread, ticks by
+// whichever runs the simulation, under the simulation lock when that is its own thread
+static TimingHistogram histograms[TIMING_METRIC_COUNT];
+
+// Maps a duration to its bucket: values below 64 have one each, larger ones share a bucket
+// with the others that agree in their top 6 bits
+static int get_bucket_index(Uint64 us) {
+    const Uint64 linear = 2 << TIMING_SUB_BITS;
+    if (us < linear) return (int)us;
+    int shift = 1;
+    while ((us >> shift) >= linear && shift < TIMING_MAX_SHIFT) shift++;
+    Uint64 top = us >> shift;
+    if (top >= linear) top = linear - 1; // Past the last power of two; clamp into the last bucket
+    return (int)(linear + (shift - 1) * (linear / 2) + (top - linear / 2));
+}
+
+// Returns the largest duration that falls in a bucket
+static Uint64 get_bucket_upper(int index) {
+    const int linear = 2 << TIMING_SUB_BITS;
+    if (index < linear) return (Uint64)index;
+    int shift = (index - linear) / (linear / 2) + 1;
+    Uint64 top = (Uint64)((index - linear) % (linear / 2) + linear / 2);
+    return ((top + 1) << shift) - 1;
+}
+
+// Adds a duration from start to end (performance counter values)
+void record_timing(TimingMetric metric, Uint64 start, Uint64 end) {
+    TimingHistogram* histogram = &histograms[metric];
+    Uint64 us = (end - start) * 1000000ULL / SDL_GetPerformanceFrequency();
+    histogram->buckets[get_bucket_index(us)]++;
+    histogram->count++;
+    histogram->sum_us += (double)us;
+    if (us > histogram->max_us) histogram->max_us = us;
+}
+
+// Returns the duration at or below which the given fraction of them fall, in microseconds
+static Uint64 get_percentile_us(const TimingHistogram* histogram, double fraction) {
+    if (histogram->count == 0) return 0;
+    Uint64 rank = (Uint64)(fraction * histogram->count + 0.999999);
+    if (rank < 1) rank = 1;
+    Uint64 seen = 0;
+    for (int i = 0; i < TIMING_BUCKETS; i++) {
+        seen += histogram->buckets[i];
+        if (seen >= rank) {
+            Uint64 upper = get_bucket_upper(i);
+            return upper < histogram->max_us ? upper : histogram->max_us;
+        }
+    }
+    return histogram->max_us;
+}
+
+void get_timing_summary(TimingMetric metric, TimingSummary* summary) {
+    const TimingHistogram* histogram = &histograms[metric];
+    summary->count = histogram->count;
+    summary->mean_ms = histogram->count ? (float)(histogram->sum_us / histogram->count / 1000.0) : 0.0f;
+    summary->p50_ms = get_percentile_us(histogram, 0.5) / 1000.0f;
+    summary->p90_ms = get_percentile_us(histogram, 0.9) / 1000.0f;
+    summary->p99_ms = get_percentile_us(histogram, 0.99) / 1000.0f;
+    summary->p999_ms = get_percentile_us(histogram, 0.999) / 1000.0f;
+    summary->max_ms = histogram->max_us / 1000.0f;
+}
+
+const char* get_timing_name(TimingMetric metric) {
+    return timing_names[metric];
+}
+
+// Prints every metric recorded so far as a table
+void print_timing_report(void) {
+    printf("%-8s %9s %8s %8s %8s %8s %8s %8s\n", "ms", "count", "mean", "p50", "p90", "p99", "p99.9", "max");
+    for (int i = 0; i < TIMING_METRIC_COUNT; i++) {
+        TimingSummary s;
+        get_timing_summary(i, &s);
+        if (s.count == 0) continue;
+        printf("%-8s %9llu %8.3f %8.3f %8.3f %8.3f %8.3f %8.3f\n", timing_names[i], (unsigned long long)s.count,
+               s.mean_ms, s.p50_ms, s.p90_ms, s.p99_ms, s.p999_ms, s.max_ms);
+    }
+}
+
+// Writes the same figures to path, as JSON if it ends in .json and CSV otherwise.
+// Returns false if the file could not be written.
+bool write_timing_report(const char* path) {
+    size_t length = my_strlen(path);
+    bool json = length >= 5 && my_strcmp(path + length - 5, ".json") == 0;
+    FILE* file = fopen(path, "w");
+    if (!file) {
+        printf("Failed to open timing report %s\n", path);
+        return false;
+    }
+    if (json) fprintf(file, "{");
+    else fprintf(file, "metric,count,mean_ms,p50_ms,p90_ms,p99_ms,p999_ms,max_ms\n");
+    for (int i = 0; i < TIMING_METRIC_COUNT; i++) {
+        TimingSummary s;
+        get_timing_summary(i, &s);
+        if (json) {
+            fprintf(file, "%s\n\"%s\":{\"count\":%llu,\"mean_ms\":%.4f,\"p50_ms\":%.4f,\"p90_ms\":%.4f,\"p99_ms\":%.4f,\"p999_ms\":%.4f,\"max_ms\":%.4f}",
+                    i ? "," : "", timing_names[i], (unsigned long long)s.count, s.mean_ms, s.p50_ms, s.p90_ms,
+                    s.p99_ms, s.p999_ms, s.max_ms);
+        } else {
+            fprintf(file, "%s,%llu,%.4f,%.4f,%.4f,%.4f,%.4f,%.4f\n", timing_names[i], (unsigned long long)s.count,
+                    s.mean_ms, s.p50_ms, s.p90_ms, s.p99_ms, s.p999_ms, s.max_ms);
+        }
+    }
+    if (json) fprintf(file, "\n}\n");
+    bool ok = !ferror(file);
+    fclose(file);
+    return ok;
+}
@@ -0,0 +1,123 @@
+#include "trace.h"
+#include "memtrack.h"
+#include <stdarg.h>
+
+static TraceEvent* events = NULL;
+static SDL_atomic_t event_count;   // Slots handed out, which can pass TRACE_MAX_EVENTS once full
+static SDL_atomic_t active;
+static Uint64 trace_origin = 0;    // Counter value at start_trace, time zero in the output
+static char trace_path[256] = TRACE_DEFAULT_PATH;
+static struct {
+    SDL_threadID id;
+    const char* name;
+} thread_names[TRACE_MAX_THREADS];
+static SDL_atomic_t thread_name_count;
+
+// Starts buffering events in memory, to be written to path (TRACE_DEFAULT_PATH if NULL) by
+// stop_trace. Returns false if already tracing, the buffer could not be allocated or the
+// profiler isn't built in.
+bool start_trace(const char* path) {
+#ifndef ENABLE_PROFILER
+    printf("Tracing not built in - rebuild with PROFILE=1\n");
+    return false;
+#endif
+    if (SDL_AtomicGet(&active)) return false;
+    if (!events) {
+        events = my_malloc(sizeof(TraceEvent) * TRACE_MAX_EVENTS);
+        if (!events) {
+            printf("Failed to allocate trace buffer\n");
+            return false;
+        }
+    }
+    if (path) snprintf(trace_path, sizeof(trace_path), "%s", path);
+    SDL_AtomicSet(&event_count, 0);
+    trace_origin = SDL_GetPerformanceCounter();
+    SDL_AtomicSet(&active, 1);
+    return true;
+}
+
+bool is_tracing(void) {
+    return SDL_AtomicGet(&active) != 0;
+}
+
+// Returns how many events are buffered
+int get_trace_event_count(void) {
+    int count = SDL_AtomicGet(&event_count);
+    return count < TRACE_MAX_EVENTS ? count : TRACE_MAX_EVENTS;
+}
+
+// Labels the calling thread in the output, e.g. "main" or "simulation"
+void name_trace_thread(const char* name) {
+    int index = SDL_AtomicAdd(&thread_name_count, 1);
+    if (index >= TRACE_MAX_THREADS) return;
+    thread_names[index].id = SDL_ThreadID();
+    thread_names[index].name = name;
+}
+
+// Records an event that ran from start to end (performance counter values) on the calling
+// thread, with arg_count pairs of argument name (a string literal) and int value.
+// Any thread may call it; it does nothing unless tracing, and drops events once the buffer is full.
+void trace_event(const char* name, Uint64 start, Uint64 end, int arg_count, ...) {
+    if (!SDL_AtomicGet(&active)) return;
+    int index = SDL_AtomicAdd(&event_count, 1);
+    if (index >= TRACE_MAX_EVENTS) return;
+    TraceEvent* event = &events[index];
+    event->name = name;
+    event->start = start;
+    event->end = end;
+    event->thread = SDL_ThreadID();
+    event->arg_count = arg_count < TRACE_MAX_ARGS ? arg_count : TRACE_MAX_ARGS;
+    va_list list;
+    va_start(list, arg_count);
+    for (int i = 0; i < event->arg_count; i++) {
+        event->arg_names[i] = va_arg(list, const char*);
+        event->args[i] = va_arg(list, int);
+    }
+    va_end(list);
+}
+
+// Stops tracing and writes the buffered events as Chrome trace-event JSON, which
+// chrome://tracing and ui.perfetto.dev open directly, to path (the one given to start_trace if
+// NULL). Other threads must not be recording (the simulation lock held, or the thread stopped).
+// Returns false if not tracing or on write failure. If the file can't be opened, tracing carries
+// on with the buffer kept, so it can be stopped again with another path.
+bool stop_trace(const char* path) {
+    if (!SDL_AtomicGet(&active)) return false;
+    if (path) snprintf(trace_path, sizeof(trace_path), "%s", path);
+    FILE* file = fopen(trace_path, "w");
+    if (!file) {
+        printf("Failed to open trace file %s, still tracing\n", trace_path);
+        return false;
+    }
+    SDL_AtomicSet(&active, 0);
+    int count = get_trace_event_count();
+    int dropped = SDL_AtomicGet(&event_count) - count;
+
+    double to_us = 1000000.0 / SDL_GetPerformanceFrequency();
+    fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    fprintf(file, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"game\"}}");
+    int named = SDL_min(SDL_AtomicGet(&thread_name_count), TRACE_MAX_THREADS);
+    for (int i = 0; i < named; i++) {
+        fprintf(file, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%lu,\"args\":{\"name\":\"%s\"}}",
+                (unsigned long)thread_names[i].id, thread_names[i].name);
+    }
+    for (int i = 0; i < count; i++) {
+        const TraceEvent* event = &events[i];
+        fprintf(file, ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%lu,\"ts\":%.3f,\"dur\":%.3f",
+                event->name, (unsigned long)event->thread,
+                (double)(Sint64)(event->start - trace_origin) * to_us, (double)(event->end - event->start) * to_us);
+        if (event->arg_count > 0) {
+            fprintf(file, ",\"args\":{");
+            for (int j = 0; j < event->arg_count; j++) {
+                fprintf(file, "%s\"%s\":%d", j ? "," : "", event->arg_names[j], event->args[j]);
+            }
+            fprintf(file, "}");
+        }
+        fprintf(file, "}");
+    }
+    fprintf(file, "\n]}\n");
+    bool ok = !ferror(file);
+    fclose(file);
+    printf("Wrote %d trace events to %s%s\n", count, trace_path, dropped > 0 ? " (buffer full, later events dropped)" : "");
+    return ok;
+}
@@ -1,5 +1,7 @@
 #include "utils.h"
 #include "common.h"
+#include "raycast.h"
+#include "memtrack.h"
 
 float absf(float x){
 	union{
@@ -64,6 +66,14 @@ float my_cosf(float x){
 	return result;
 }
 
+// Interpolates between two angles in degrees along the shorter arc
+float lerp_angle(float from, float to, float t) {
+	float diff = to - from;
+	while (diff > 180.0f) diff -= 360.0f;
+	while (diff < -180.0f) diff += 360.0f;
+	return from + diff * t;
+}
+
 float my_sinf(float x){
 	while(x>MA_PI) x -= 2.0f * MA_PI;
 	while(x<-MA_PI) x += 2.0f * MA_PI;
@@ -83,7 +93,7 @@ SDL_Texture* load_texture(const char* path, SDL_Renderer* renderer) {
 		printf("Failed to load image %s: %s\n", path, IMG_GetError());
 		return NULL;
 	}
-	SDL_Texture* texture = SDL_CreateTextureFromSurface(renderer, surface);
+	SDL_Texture* texture = create_tracked_texture_from_surface(renderer, surface, "image");
 	SDL_FreeSurface(surface);
 	if (!texture) {
 		printf("Failed to create texture: %s\n", SDL_GetError());
@@ -92,7 +102,7 @@ SDL_Texture* load_texture(const char* path, SDL_Renderer* renderer) {
 }
 
 SDL_Texture* create_background_texture(SDL_Renderer* renderer, SDL_Texture* tile, int world_w, int world_h) {
-	SDL_Texture* bg = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET, world_w, world_h);
+	SDL_Texture* bg = create_tracked_texture(renderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET, world_w, world_h, "background");
 	SDL_SetRenderTarget(renderer, bg);
 	for (int y = 0; y < world_h; y += TILE_SIZE) {
 		for (int x = 0; x < world_w; x += TILE_SIZE) {
@@ -105,12 +115,17 @@ SDL_Texture* create_background_texture(SDL_Renderer* renderer, SDL_Texture* tile
 }
 
 void init_walls(World* world, SDL_Renderer* renderer, SDL_Texture* wall_texture_S, SDL_Texture* wall_texture_B, SDL_Texture* wall_texture_O) {
+	world->wall_textures[WALL_NONE] = NULL;
+	world->wall_textures[WALL_SMALL] = wall_texture_S;
+	world->wall_textures[WALL_BULLETPROOF] = wall_texture_B;
+	world->wall_textures[WALL_OPAQUE] = wall_texture_O;
+
 	int wall_count = 0;
 	for (int y = 0; y < MAP_SIZE; y++)
 		for (int x = 0; x < MAP_SIZE; x++)
 			if (world->map[y][x] == WALL_SMALL || world->map[y][x] == WALL_BULLETPROOF || world->map[y][x] == WALL_OPAQUE)
 				wall_count++;
-	world->walls = (Wall*)malloc(wall_count * sizeof(Wall));
+	world->walls = (Wall*)my_malloc(wall_count * sizeof(Wall));
 	world->wall_count = wall_count;
 
 	uint8_t temp_map[MAP_SIZE][MAP_SIZE];
@@ -137,7 +152,9 @@ void init_walls(World* world, SDL_Renderer* renderer, SDL_Texture* wall_texture_
 	int index = 0;
 	for (int y = 0; y < MAP_SIZE; y++) {
 		for (int x = 0; x < MAP_SIZE; x++) {
+			world->wall_at[y][x] = -1;
 			if (world->map[y][x] == WALL_SMALL || world->map[y][x] == WALL_BULLETPROOF || world->map[y][x] == WALL_OPAQUE) {
+				world->wall_at[y][x] = index;
 				world->walls[index].x = x * TILE_SIZE;
 				world->walls[index].y = y * TILE_SIZE;
 				world->walls[index].w = TILE_SIZE;
@@ -156,6 +173,42 @@ void init_walls(World* world, SDL_Renderer* renderer, SDL_Texture* wall_texture_
 	}
 }
 
+// Changes one map tile at runtime. Keeps the wall array and per-tile wall lookup in step, bumps the
+// map version so derived data is rebuilt, and marks the map chunk holding the tile for re-baking.
+bool set_map_tile(World* world, int x, int y, WallType type) {
+	if (!world || x < 0 || x >= MAP_SIZE || y < 0 || y >= MAP_SIZE || type > WALL_OPAQUE) return false;
+	if (world->map[y][x] == type) return true;
+
+	int index = world->wall_at[y][x];
+	if (type == WALL_NONE) {
+		// The wall stays in the array as WALL_NONE, which every wall loop already skips, and its
+		// slot is reused if the tile gets a wall again
+		if (index >= 0) world->walls[index].type = WALL_NONE;
+	} else {
+		if (index < 0) {
+			Wall* walls = (Wall*)my_realloc(world->walls, (world->wall_count + 1) * sizeof(Wall));
+			if (!walls) {
+				printf("Error: Failed to grow wall array\n");
+				return false;
+			}
+			world->walls = walls;
+			index = world->wall_count++;
+			world->wall_at[y][x] = index;
+			world->walls[index].x = x * TILE_SIZE;
+			world->walls[index].y = y * TILE_SIZE;
+			world->walls[index].w = TILE_SIZE;
+			world->walls[index].h = TILE_SIZE;
+		}
+		world->walls[index].type = type;
+		world->walls[index].texture = world->wall_textures[type];
+	}
+
+	world->map[y][x] = type;
+	world->map_version++;
+	world->chunk_dirty[y * TILE_SIZE / MAP_CHUNK_SIZE][x * TILE_SIZE / MAP_CHUNK_SIZE] = true;
+	return true;
+}
+
 bool check_collision(float x1, float y1, float w1, float h1, float x2, float y2, float w2, float h2) {
 	return (x1 < x2 + w2 && x1 + w1 > x2 && y1 < y2 + h2 && y1 + h1 > y2);
 }
@@ -177,49 +230,11 @@ bool has_line_of_sight(float start_x, float start_y, float end_x, float end_y, W
         return true;
     }
 
-    // Convert pixel coordinates to tile coordinates
-    int x0 = (int)(start_x / TILE_SIZE);
-    int y0 = (int)(start_y / TILE_SIZE);
-    int x1 = (int)(end_x / TILE_SIZE);
-    int y1 = (int)(end_y / TILE_SIZE);
-
-    // Bresenham's line algorithm
-    int dx = absi(x1 - x0);
-    int dy = absi(y1 - y0);
-    int sx = x0 < x1 ? 1 : -1;
-    int sy = y0 < y1 ? 1 : -1;
-    int err = dx - dy;
-
-    while (true) {
-        // Check if current tile is within bounds
-        if (x0 < 0 || x0 >= MAP_SIZE || y0 < 0 || y0 >= MAP_SIZE) {
-            return false;
-        }
-
-        // Check if current tile blocks line of sight
-        if ((block_by_bulletproof && world->map[y0][x0] == WALL_BULLETPROOF) ||
-            (block_by_opaque && world->map[y0][x0] == WALL_OPAQUE)) {
-            return false;
-        }
-
-        // Reached the end tile
-        if (x0 == x1 && y0 == y1) {
-            break;
-        }
-
-        // Move to next tile
-        int e2 = 2 * err;
-        if (e2 > -dy) {
-            err -= dy;
-            x0 += sx;
-        }
-        if (e2 < dx) {
-            err += dx;
-            y0 += sy;
-        }
-    }
-
-    return true;
+    // Trace the segment with raycast.c's single-ray DDA, measuring distance as a fraction of its
+    // length. Each call is one scalar ray from its own origin, so enemy sight checks don't go
+    // through the SSE2 packet path that cast_rays uses for batches from one origin.
+    unsigned block_mask = (block_by_bulletproof ? RAY_BLOCK(WALL_BULLETPROOF) : 0) | (block_by_opaque ? RAY_BLOCK(WALL_OPAQUE) : 0);
+    return cast_ray(start_x, start_y, end_x - start_x, end_y - start_y, 1.0f, block_mask, world, NULL) >= 1.0f;
 }
 
 void SDL_RenderFillPolygon(SDL_Renderer* renderer, const SDL_Point* points, int count) {
@@ -238,7 +253,7 @@ void SDL_RenderFillPolygon(SDL_Renderer* renderer, const SDL_Point* points, int
     // Iterate over each scanline
     for (int y = min_y; y <= max_y; y++) {
         // Collect intersections with the scanline
-        int intersections[362]; // Max number of intersections (same as max points in render_fov)
+        int intersections[FOV_MAX_RAYS + 2]; // Max number of intersections (same as max points in render_fov)
         int intersection_count = 0;
 
         for (int i = 0; i < count; i++) {
@@ -291,43 +306,19 @@ float ray_aabb_intersect(float px, float py, float dx, float dy, float minx, flo
     return tmin;
 }
 
+// Returns the distance along a unit direction to the first opaque tile, capped at FOV_RANGE
 float get_visibility_distance(float x1, float y1, float dx, float dy, World* world) {
-    // Normalize direction if needed (assume unit vector, but ensure length=1)
-    float length = my_sqrt(dx*dx + dy*dy);
-    if (length > 0) { dx /= length; dy /= length; }
-
-    float ray_x = x1, ray_y = y1;
-    int tile_x = (int)(ray_x / TILE_SIZE);
-    int tile_y = (int)(ray_y / TILE_SIZE);
-    float max_dist = FOV_RANGE;  // Cap to avoid infinite loops
-    float dist = 0.0f;
-
-    int step_x = (dx > 0) ? 1 : -1;
-    int step_y = (dy > 0) ? 1 : -1;
-    float t_delta_x = (dx != 0) ? TILE_SIZE / absf(dx) : 1e30f;
-    float t_delta_y = (dy != 0) ? TILE_SIZE / absf(dy) : 1e30f;
-    float t_max_x = (dx > 0 ? (tile_x + 1) * TILE_SIZE - ray_x : ray_x - tile_x * TILE_SIZE) / absf(dx);
-    float t_max_y = (dy > 0 ? (tile_y + 1) * TILE_SIZE - ray_y : ray_y - tile_y * TILE_SIZE) / absf(dy);
-
-    while (dist < max_dist) {
-        if (tile_x < 0 || tile_x >= MAP_SIZE || tile_y < 0 || tile_y >= MAP_SIZE) break;
-        if (world->map[tile_y][tile_x] == WALL_OPAQUE) {
-            return dist;  // Hit opaque tile
-        }
+    return cast_ray(x1, y1, dx, dy, FOV_RANGE, RAY_BLOCK(WALL_OPAQUE), world, NULL);
+}
 
-        if (t_max_x < t_max_y) {
-            dist = t_max_x;
-            t_max_x += t_delta_x;
-            tile_x += step_x;
-        } else {
-            dist = t_max_y;
-            t_max_y += t_delta_y;
-            tile_y += step_y;
-        }
-        ray_x = x1 + dx * dist;
-        ray_y = y1 + dy * dist;
+// FNV-1a hash, chainable by passing the previous result (start with 2166136261u)
+Uint32 hash_bytes(Uint32 hash, const void* data, size_t size) {
+    const uint8_t* bytes = (const uint8_t*)data;
+    for (size_t i = 0; i < size; i++) {
+        hash ^= bytes[i];
+        hash *= 16777619u;
     }
-    return max_dist;  // No hit
+    return hash;
 }
 
 size_t my_strlen(const char *str) {
@@ -0,0 +1,199 @@
+#include "visibility.h"
+#include "utils.h"
+#include "raycast.h"
+
+// Represents one ray of the angular sweep
+typedef struct{
+    float key;         // Pseudo-angle from the start of the cone, in [0, 4)
+    float dx, dy;      // Unit direction
+} SweepRay;
+
+// Maps a direction to [0, 4) monotonically with its angle. Cheaper than my_atan2f and,
+// unlike it, exact enough to order rays a fraction of a degree apart.
+static float pseudo_angle(float x, float y) {
+    float sum = absf(x) + absf(y);
+    if (sum == 0.0f) return 0.0f;
+    float p = x / sum;
+    return (y < 0.0f) ? 3.0f + p : 1.0f - p;
+}
+
+static int compare_sweep_rays(const void* a, const void* b) {
+    float ka = ((const SweepRay*)a)->key;
+    float kb = ((const SweepRay*)b)->key;
+    return (ka > kb) - (ka < kb);
+}
+
+// Adds a ray if it falls inside the cone. (start_cos, start_sin) is the cone's first edge
+// and limit is the pseudo-angle of its last edge (4 for a full circle).
+static void add_sweep_ray(SweepRay* rays, int* count, int max_rays, float dx, float dy,
+                          float start_cos, float start_sin, float limit) {
+    if (*count >= max_rays) return;
+    float rel_x = dx * start_cos + dy * start_sin;
+    float rel_y = dy * start_cos - dx * start_sin;
+    float key = pseudo_angle(rel_x, rel_y);
+    if (key > limit) return;
+    rays[(*count)++] = (SweepRay){key, dx, dy};
+}
+
+// Returns whether a grid corner is a vertex of the opaque wall outline: exactly one or three
+// of the four tiles around it are opaque, or two diagonal ones are
+static bool is_outline_corner(int cx, int cy, World* world) {
+    bool tl = cx > 0 && cy > 0 && world->map[cy - 1][cx - 1] == WALL_OPAQUE;
+    bool tr = cx < MAP_SIZE && cy > 0 && world->map[cy - 1][cx] == WALL_OPAQUE;
+    bool bl = cx > 0 && cy < MAP_SIZE && world->map[cy][cx - 1] == WALL_OPAQUE;
+    bool br = cx < MAP_SIZE && cy < MAP_SIZE && world->map[cy][cx] == WALL_OPAQUE;
+    int count = tl + tr + bl + br;
+    return count == 1 || count == 3 || (count == 2 && tl == br);
+}
+
+// Builds the visibility polygon of a cone (half_angle_rad >= MA_PI for a full circle) as rays
+// sorted by angle. Rays go to both edges of the cone, along the arc at the spacing needed to
+// stay within FOV_ARC_TOLERANCE, and at and just past every opaque wall corner in range, so the
+// ray count grows with nearby geometry instead of being fixed. Returns the number of rays written.
+// Its working buffers are static, so it isn't reentrant: only the thread that ticks the
+// simulation calls it, through publish_render_snapshot.
+int build_visibility_polygon(float origin_x, float origin_y, float facing_rad, float half_angle_rad, float range,
+                             World* world, float* cos_out, float* sin_out, float* dist_out, int max_rays) {
+    static SweepRay rays[FOV_MAX_RAYS];
+    static int corner_stamp[MAP_SIZE + 1][MAP_SIZE + 1];
+    static int stamp = 0;
+    if (max_rays > FOV_MAX_RAYS) max_rays = FOV_MAX_RAYS;
+    if (!world || max_rays < 2) return 0;
+
+    bool full_circle = half_angle_rad >= MA_PI;
+    float span = full_circle ? 2.0f * MA_PI : 2.0f * half_angle_rad;
+    float start = full_circle ? 0.0f : facing_rad - half_angle_rad;
+    float start_cos = my_cosf(start);
+    float start_sin = my_sinf(start);
+    float limit = full_circle ? 4.0f : pseudo_angle(my_cosf(span), my_sinf(span));
+    int count = 0;
+
+    // Edges of the cone and samples along the arc. A chord spanning angle a sags r * a^2 / 8
+    // below the arc, so steps of sqrt(8 * tolerance / r) keep the gap under the tolerance.
+    float max_step = my_sqrt(8.0f * FOV_ARC_TOLERANCE / range);
+    int segments = (int)(span / max_step) + 1;
+    for (int i = 0; i <= segments; i++) {
+        if (full_circle && i == segments) break; // Last sample would repeat the first
+        float t = span * i / segments;
+        float dx = my_cosf(t) * start_cos - my_sinf(t) * start_sin;
+        float dy = my_sinf(t) * start_cos + my_cosf(t) * start_sin;
+        if (count < max_rays) {
+            float rel = (i == segments) ? limit : pseudo_angle(my_cosf(t), my_sinf(t));
+            rays[count++] = (SweepRay){rel, dx, dy};
+        }
+    }
+
+    // Outline corners of opaque walls within range
+    if (++stamp == 0) {
+        memset(corner_stamp, 0, sizeof(corner_stamp));
+        stamp = 1;
+    }
+    float eps_cos = my_cosf(FOV_CORNER_EPSILON);
+    float eps_sin = my_sinf(FOV_CORNER_EPSILON);
+    int min_tx = (int)((origin_x - range) / TILE_SIZE), max_tx = (int)((origin_x + range) / TILE_SIZE);
+    int min_ty = (int)((origin_y - range) / TILE_SIZE), max_ty = (int)((origin_y + range) / TILE_SIZE);
+    if (origin_x - range < 0) min_tx = 0;
+    if (origin_y - range < 0) min_ty = 0;
+    if (max_tx >= MAP_SIZE) max_tx = MAP_SIZE - 1;
+    if (max_ty >= MAP_SIZE) max_ty = MAP_SIZE - 1;
+
+    for (int ty = min_ty; ty <= max_ty; ty++) {
+        for (int tx = min_tx; tx <= max_tx; tx++) {
+            if (world->map[ty][tx] != WALL_OPAQUE) continue;
+            for (int c = 0; c < 4; c++) {
+                int cx = tx + (c & 1);
+                int cy = ty + (c >> 1);
+                if (corner_stamp[cy][cx] == stamp) continue;
+                corner_stamp[cy][cx] = stamp;
+                if (!is_outline_corner(cx, cy, world)) continue;
+
+                float dx = cx * TILE_SIZE - origin_x;
+                float dy = cy * TILE_SIZE - origin_y;
+                float dist_sq = dx * dx + dy * dy;
+                if (dist_sq > range * range || dist_sq == 0.0f) continue;
+                float len = my_sqrt(dist_sq);
+                dx /= len;
+                dy /= len;
+
+                // One ray at the corner and one just past it on each side
+                add_sweep_ray(rays, &count, max_rays, dx, dy, start_cos, start_sin, limit);
+                add_sweep_ray(rays, &count, max_rays, dx * eps_cos - dy * eps_sin, dy * eps_cos + dx * eps_sin,
+                              start_cos, start_sin, limit);
+                add_sweep_ray(rays, &count, max_rays, dx * eps_cos + dy * eps_sin, dy * eps_cos - dx * eps_sin,
+                              start_cos, start_sin, limit);
+            }
+        }
+    }
+
+    qsort(rays, count, sizeof(SweepRay), compare_sweep_rays);
+
+    // Trace all sweep rays as one batch
+    static float ray_dx[FOV_MAX_RAYS], ray_dy[FOV_MAX_RAYS], ray_dist[FOV_MAX_RAYS];
+    for (int i = 0; i < count; i++) {
+        ray_dx[i] = rays[i].dx;
+        ray_dy[i] = rays[i].dy;
+    }
+    cast_rays(origin_x, origin_y, ray_dx, ray_dy, count, range, RAY_BLOCK(WALL_OPAQUE), world, ray_dist, NULL);
+
+    // Full circles repeat the first ray at the end to close the fan
+    int total = count;
+    if (full_circle && count > 0) total++;
+    int out_count = 0;
+    for (int i = 0; i < total && out_count < max_rays; i++) {
+        SweepRay* ray = &rays[i < count ? i : 0];
+        float dist = ray_dist[i < count ? i : 0];
+
+        // A wall face crossing the range circle has no corner in range to aim at,
+        // so the switch from a capped ray to a wall hit is found by bisection
+        if (out_count > 0 && (dist >= range) != (dist_out[out_count - 1] >= range) && out_count + 3 <= max_rays) {
+            float ax = cos_out[out_count - 1], ay = sin_out[out_count - 1], a_dist = dist_out[out_count - 1];
+            float bx = ray->dx, by = ray->dy, b_dist = dist;
+            bool a_capped = a_dist >= range;
+            for (int step = 0; step < FOV_REFINE_STEPS; step++) {
+                float mx = ax + bx, my = ay + by;
+                float len = my_sqrt(mx * mx + my * my);
+                if (len == 0.0f) break;
+                mx /= len;
+                my /= len;
+                float m_dist = cast_ray(origin_x, origin_y, mx, my, range, RAY_BLOCK(WALL_OPAQUE), world, NULL);
+                if ((m_dist >= range) == a_capped) {
+                    ax = mx; ay = my; a_dist = m_dist;
+                } else {
+                    bx = mx; by = my; b_dist = m_dist;
+                }
+            }
+            cos_out[out_count] = ax; sin_out[out_count] = ay; dist_out[out_count++] = a_dist;
+            cos_out[out_count] = bx; sin_out[out_count] = by; dist_out[out_count++] = b_dist;
+        }
+
+        cos_out[out_count] = ray->dx;
+        sin_out[out_count] = ray->dy;
+        dist_out[out_count++] = dist;
+    }
+    return out_count;
+}
+
+// Builds the FOV mask polygons for the player: the 90-degree, FOV_RANGE sector around its facing
+// and the 360-degree, FOV_CIRCLE_R circle. If previous was built for the same player centre, angle
+// and map version it is copied instead of traced again.
+void build_fov_polygons(FovPolygons* fov, const FovPolygons* previous, Player* player, World* world) {
+    float player_x = player->x + player->w / 2.0f;
+    float player_y = player->y + player->h / 2.0f;
+    Uint32 hash = 2166136261u;
+    hash = hash_bytes(hash, &player_x, sizeof(player_x));
+    hash = hash_bytes(hash, &player_y, sizeof(player_y));
+    hash = hash_bytes(hash, &player->angle, sizeof(player->angle));
+    hash = hash_bytes(hash, &world->map_version, sizeof(world->map_version));
+    if (previous && previous->hash == hash && previous->sector_rays > 0) {
+        if (previous != fov) memcpy(fov, previous, sizeof(FovPolygons));
+        return;
+    }
+
+    float angle_rad = player->angle * (MA_PI / 180.0f);
+    float half_fov_rad = FOV_HALF_ANGLE * (MA_PI / 180.0f);
+    fov->sector_rays = build_visibility_polygon(player_x, player_y, angle_rad, half_fov_rad, FOV_RANGE, world,
+                                                fov->sector_cos, fov->sector_sin, fov->sector_dist, FOV_MAX_RAYS);
+    fov->circle_rays = build_visibility_polygon(player_x, player_y, 0.0f, MA_PI, FOV_CIRCLE_R, world,
+                                                fov->circle_cos, fov->circle_sin, fov->circle_dist, FOV_MAX_RAYS);
+    fov->hash = hash;
+}
@@ -0,0 +1,223 @@
+// Times the bullet and wall-collision loops of a fixed update on their own, on the game level or
+// test/maze.txt filled with seeded bullets and enemies.
+// Usage: collisionBench [bullets] [enemies] [level|maze] [trials]
+// Each case is warmed up, then timed over a number of trials of about BENCH_TRIAL_MS worth of
+// calls each, and never fewer than BENCH_MIN_REPS, so a slow case is still averaged over several
+// calls per trial. The wall cases move copies of the positions, so they change nothing and each
+// trial is timed as one batch of calls. The bullet cases change state that is restored between
+// calls (untimed), so each call is timed on its own and the measured cost of reading the timer is
+// taken off. Prints min/median/mean ns per entity over the trials, where an entity is a bullet for
+// update_bullets and an enemy otherwise. Bullet hits scan every one of the MAX_BULLETS slots,
+// used or not.
+#include "common.h"
+#include "types.h"
+#include "utils.h"
+#include "game.h"
+#include "level.h"
+#include "random.h"
+#include "memtrack.h"
+
+SDL_Texture* fov_mask = NULL;
+
+static const int maze[MAP_SIZE][MAP_SIZE] = {
+#include "maze.txt"
+};
+
+#define BENCH_DEFAULT_TRIALS 15
+#define BENCH_WARMUP_REPS 20
+#define BENCH_TRIAL_MS 20.0
+#define BENCH_MIN_REPS 10
+#define BENCH_MAX_REPS 1000000
+#define BENCH_TIMER_SAMPLES 10000
+
+static World world;
+static Player player;
+static Enemy enemies[MAX_ENEMIES];
+static Bullet bullets[MAX_BULLETS];
+static Bullet initial_bullets[MAX_BULLETS];
+static int bullet_count, enemy_count;
+
+// What the cases change on enemies, restored between calls; a whole Enemy is too big to copy
+static struct {
+    float x, y, hp;
+    bool active, in_cover;
+    EnemyState state;
+} initial_enemies[MAX_ENEMIES];
+static volatile float position_sink; // Where the wall cases leave their results
+static double timer_overhead; // Mean counter ticks between two back-to-back counter reads
+
+// Picks a random open tile, returning the pixel position of its top-left corner
+static void random_open_position(RandomStream* rng, float* x, float* y) {
+    int tile_x, tile_y;
+    do {
+        tile_x = random_below(rng, MAP_SIZE);
+        tile_y = random_below(rng, MAP_SIZE);
+    } while (world.map[tile_y][tile_x] != WALL_NONE);
+    *x = (float)(tile_x * TILE_SIZE);
+    *y = (float)(tile_y * TILE_SIZE);
+}
+
+static void populate(Uint64 seed) {
+    RandomStream rng;
+    init_random_stream(&rng, seed, random_stream_selector(RANDOM_SPAWN, 0));
+    for (int i = 0; i < bullet_count; i++) {
+        Entity shooter = {0};
+        random_open_position(&rng, &shooter.x, &shooter.y);
+        shooter.w = shooter.h = 48;
+        shooter.angle = (float)random_below(&rng, 360);
+        spawn_bullet(bullets, &shooter, random_below(&rng, 4) != 0); // Mostly player bullets, which can hit
+    }
+    for (int i = 0; i < enemy_count; i++) {
+        Enemy* enemy = &enemies[i];
+        random_open_position(&rng, &enemy->x, &enemy->y);
+        enemy->w = enemy->h = 48;
+        enemy->hp = ENEMY_HP;
+        enemy->active = true;
+        enemy->state = FREE;
+        enemy->in_cover = random_below(&rng, 2) != 0;
+        enemy->vel_x = (float)(random_below(&rng, 5) - 2);
+        enemy->vel_y = (float)(random_below(&rng, 5) - 2);
+        initial_enemies[i].x = enemy->x;
+        initial_enemies[i].y = enemy->y;
+        initial_enemies[i].hp = enemy->hp;
+        initial_enemies[i].active = enemy->active;
+        initial_enemies[i].in_cover = enemy->in_cover;
+        initial_enemies[i].state = enemy->state;
+    }
+    memcpy(initial_bullets, bullets, sizeof(bullets));
+    random_open_position(&rng, &player.x, &player.y);
+    player.w = player.h = 48;
+    player.vel_x = 3.0f;
+    player.vel_y = -3.0f;
+}
+
+static void reset_bullets(void) {
+    memcpy(bullets, initial_bullets, sizeof(bullets));
+}
+
+static void reset_enemies(void) {
+    memcpy(bullets, initial_bullets, sizeof(bullets));
+    for (int i = 0; i < enemy_count; i++) {
+        enemies[i].x = initial_enemies[i].x;
+        enemies[i].y = initial_enemies[i].y;
+        enemies[i].hp = initial_enemies[i].hp;
+        enemies[i].active = initial_enemies[i].active;
+        enemies[i].in_cover = initial_enemies[i].in_cover;
+        enemies[i].state = initial_enemies[i].state;
+    }
+}
+
+static void run_update_bullets(void) {
+    update_bullets(bullets, &world, fixed_dt);
+}
+
+static void run_bullet_hits(void) {
+    for (int i = 0; i < enemy_count; i++) {
+        if (enemies[i].active) hit_enemy_with_bullets(&enemies[i], bullets);
+    }
+}
+
+static void run_player_walls(void) {
+    float x = player.x, y = player.y;
+    move_with_wall_collision(&x, &y, player.w, player.h, player.vel_x, player.vel_y, &world);
+    position_sink = x + y;
+}
+
+static void run_enemy_walls(void) {
+    for (int i = 0; i < enemy_count; i++) {
+        float x = enemies[i].x, y = enemies[i].y;
+        move_with_wall_collision(&x, &y, enemies[i].w, enemies[i].h, enemies[i].vel_x, enemies[i].vel_y, &world);
+        position_sink = x + y;
+    }
+}
+
+// Measures what a pair of counter reads costs, to take off calls timed one by one
+static void measure_timer_overhead(void) {
+    Uint64 total = 0;
+    for (int i = 0; i < BENCH_TIMER_SAMPLES; i++) {
+        Uint64 start = SDL_GetPerformanceCounter();
+        total += SDL_GetPerformanceCounter() - start;
+    }
+    timer_overhead = (double)total / BENCH_TIMER_SAMPLES;
+}
+
+// Times reps calls, returning counter ticks. Without a reset the calls are timed as one batch;
+// with one, each call is timed on its own, less the timer overhead.
+static double time_reps(void (*reset)(void), void (*run)(void), int reps) {
+    if (!reset) {
+        Uint64 start = SDL_GetPerformanceCounter();
+        for (int i = 0; i < reps; i++) run();
+        return (double)(SDL_GetPerformanceCounter() - start);
+    }
+    double total = 0.0;
+    for (int i = 0; i < reps; i++) {
+        reset();
+        Uint64 start = SDL_GetPerformanceCounter();
+        run();
+        total += (double)(SDL_GetPerformanceCounter() - start) - timer_overhead;
+    }
+    return total > 0.0 ? total : 0.0;
+}
+
+static int compare_doubles(const void* a, const void* b) {
+    double da = *(const double*)a, db = *(const double*)b;
+    return (da > db) - (da < db);
+}
+
+// Times one case and prints its ns per entity over the trials. reset is NULL for cases that
+// change no state.
+static void bench_case(const char* name, void (*reset)(void), void (*run)(void), int entities, int trials) {
+    if (entities <= 0) {
+        printf("%-16s %7d entities  (skipped)\n", name, entities);
+        return;
+    }
+    const double ns_per_count = 1000000000.0 / SDL_GetPerformanceFrequency();
+    double warmup = time_reps(reset, run, BENCH_WARMUP_REPS);
+    // Enough calls per trial to fill BENCH_TRIAL_MS, going by the warmup, but at least
+    // BENCH_MIN_REPS so a slow case isn't one call per trial
+    double call_ns = warmup * ns_per_count / BENCH_WARMUP_REPS;
+    double fill = call_ns > 0.0 ? BENCH_TRIAL_MS * 1000000.0 / call_ns : BENCH_MAX_REPS;
+    int reps = fill < BENCH_MIN_REPS ? BENCH_MIN_REPS : fill > BENCH_MAX_REPS ? BENCH_MAX_REPS : (int)fill;
+
+    double* ns = malloc(sizeof(double) * trials);
+    double sum = 0.0;
+    for (int trial = 0; trial < trials; trial++) {
+        ns[trial] = time_reps(reset, run, reps) * ns_per_count / ((double)reps * entities);
+        sum += ns[trial];
+    }
+    qsort(ns, trials, sizeof(double), compare_doubles);
+    printf("%-16s %7d entities %6d calls  min %9.2f  median %9.2f  mean %9.2f ns/entity\n", name, entities,
+           reps, ns[0], ns[trials / 2], sum / trials);
+    free(ns);
+}
+
+int main(int argc, char* argv[]) {
+    bullet_count = argc > 1 ? atoi(argv[1]) : MAX_BULLETS;
+    enemy_count = argc > 2 ? atoi(argv[2]) : MAX_ENEMIES;
+    bool use_maze = argc > 3 && my_strcmp(argv[3], "maze") == 0;
+    int trials = argc > 4 ? atoi(argv[4]) : BENCH_DEFAULT_TRIALS;
+    if (bullet_count < 0 || bullet_count > MAX_BULLETS || enemy_count < 0 || enemy_count > MAX_ENEMIES || trials <= 0) {
+        printf("Usage: %s [bullets, up to %d] [enemies, up to %d] [level|maze] [trials]\n", argv[0], MAX_BULLETS, MAX_ENEMIES);
+        return 1;
+    }
+
+    load_level_map(&world);
+    if (use_maze) {
+        for (int y = 0; y < MAP_SIZE; y++) {
+            for (int x = 0; x < MAP_SIZE; x++) world.map[y][x] = (uint8_t)maze[y][x];
+        }
+    }
+    init_walls(&world, NULL, NULL, NULL, NULL);
+    populate(1);
+    measure_timer_overhead();
+    printf("%s: %d walls, %d bullets (%d slots), %d enemies, %d trials, %.1f ns timer overhead\n", use_maze ? "maze" : "level",
+           world.wall_count, bullet_count, MAX_BULLETS, enemy_count, trials, timer_overhead * 1000000000.0 / SDL_GetPerformanceFrequency());
+
+    bench_case("update_bullets", reset_bullets, run_update_bullets, bullet_count, trials);
+    bench_case("bullet hits", reset_enemies, run_bullet_hits, enemy_count, trials);
+    bench_case("player walls", NULL, run_player_walls, 1, trials);
+    bench_case("enemy walls", NULL, run_enemy_walls, enemy_count, trials);
+
+    my_free(world.walls);
+    return 0;
+}
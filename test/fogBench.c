@@ -0,0 +1,87 @@
+// Benchmarks the FOV mask backends on SDL's software renderer at 1080p and 4K.
+// Every frame turns the player so the mask is redrawn, then composites it onto the screen.
+#include "common.h"
+#include "types.h"
+#include "utils.h"
+#include "render.h"
+#include "visibility.h"
+#include "memtrack.h"
+
+SDL_Texture* fov_mask = NULL;
+
+static const int maze[MAP_SIZE][MAP_SIZE] = {
+#include "maze.txt"
+};
+
+#define BENCH_FRAMES 200
+
+// Returns the average milliseconds per frame for one backend at one output size
+static double bench_backend(World* world, int w, int h, FovBackend backend, int soft_scale) {
+    SDL_Surface* surface = SDL_CreateRGBSurfaceWithFormat(0, w, h, 32, SDL_PIXELFORMAT_RGBA8888);
+    if (!surface) {
+        printf("SDL_CreateRGBSurfaceWithFormat failed: %s\n", SDL_GetError());
+        return -1.0;
+    }
+    SDL_Renderer* renderer = SDL_CreateSoftwareRenderer(surface);
+    if (!renderer) {
+        printf("SDL_CreateSoftwareRenderer failed: %s\n", SDL_GetError());
+        SDL_FreeSurface(surface);
+        return -1.0;
+    }
+
+    SDL_Texture* mask = NULL;
+    set_fov_backend(backend, soft_scale);
+    init_fov_mask(renderer, &mask, w + 2 * FOV_MASK_MARGIN, h + 2 * FOV_MASK_MARGIN);
+    double ms = -1.0;
+    if (mask) {
+        // Stand in the middle of the first open tile near the centre of the maze
+        Player player = {0};
+        player.w = player.h = 32;
+        for (int i = 0; i < MAP_SIZE * MAP_SIZE; i++) {
+            int x = (MAP_SIZE / 2 + i) % MAP_SIZE, y = (MAP_SIZE / 2 + i / MAP_SIZE) % MAP_SIZE;
+            if (world->map[y][x] == WALL_NONE) {
+                player.x = x * TILE_SIZE;
+                player.y = y * TILE_SIZE;
+                break;
+            }
+        }
+        Camera camera = {player.x + player.w / 2 - w / 2, player.y + player.h / 2 - h / 2, w, h};
+
+        Uint64 start = SDL_GetPerformanceCounter();
+        for (int frame = 0; frame < BENCH_FRAMES; frame++) {
+            static FovPolygons fov;
+            player.angle = (float)(frame * 7 % 360);
+            build_fov_polygons(&fov, NULL, &player, world);
+            render_fov(renderer, &fov, &player, &camera, mask);
+        }
+        ms = (double)(SDL_GetPerformanceCounter() - start) * 1000.0 / SDL_GetPerformanceFrequency() / BENCH_FRAMES;
+        destroy_tracked_texture(mask);
+    }
+    SDL_DestroyRenderer(renderer);
+    SDL_FreeSurface(surface);
+    return ms;
+}
+
+int main(int argc, char* argv[]) {
+    (void)argc;
+    (void)argv;
+    static World world;
+    world.w = WORLD_W;
+    world.h = WORLD_H;
+    for (int y = 0; y < MAP_SIZE; y++) {
+        for (int x = 0; x < MAP_SIZE; x++) {
+            world.map[y][x] = maze[y][x];
+        }
+    }
+
+    const int sizes[2][2] = {{1920, 1080}, {3840, 2160}};
+    printf("%-10s %14s %14s %14s\n", "output", "geometry", "software x1", "software x2");
+    for (int i = 0; i < 2; i++) {
+        int w = sizes[i][0], h = sizes[i][1];
+        double geometry = bench_backend(&world, w, h, FOV_BACKEND_GEOMETRY, 1);
+        double soft_full = bench_backend(&world, w, h, FOV_BACKEND_SOFTWARE, 1);
+        double soft_half = bench_backend(&world, w, h, FOV_BACKEND_SOFTWARE, 2);
+        printf("%4dx%-5d %11.3f ms %11.3f ms %11.3f ms\n", w, h, geometry, soft_full, soft_half);
+    }
+    return 0;
+}
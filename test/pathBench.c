@@ -0,0 +1,279 @@
+// Benchmarks find_path on the game level, test/maze.txt and random maps of increasing density.
+// Usage: pathBench [queries per map] [seed] [save|check <results file>]
+// Every map gets the same seeded start/goal pairs on each run. For each map it prints queries per
+// second, nodes expanded per query, path length and how many paths were optimal, checked against
+// a Dijkstra search over the same grid. "save" writes every query's result to a file and "check"
+// compares a run against one, so an optimised find_path can be diffed against the current one:
+//   ./test/pathBench 2000 1 save before.txt   (current find_path)
+//   ./test/pathBench 2000 1 check before.txt  (after the change)
+// Exits non-zero if any path is invalid, or "check" finds one lost or made longer.
+#include "common.h"
+#include "types.h"
+#include "utils.h"
+#include "level.h"
+#include "pathfinding.h"
+#include "random.h"
+
+SDL_Texture* fov_mask = NULL;
+
+static const int maze[MAP_SIZE][MAP_SIZE] = {
+#include "maze.txt"
+};
+
+#define BENCH_DEFAULT_QUERIES 2000
+#define BENCH_MAP_COUNT 6
+#define BENCH_MAX_MISMATCHES 10 // Mismatches printed in full by "check"; the rest are only counted
+
+// Random maps are this share of blocking walls, in thousandths, scattered uniformly
+static const struct {
+    const char* name;
+    int density;
+} bench_maps[BENCH_MAP_COUNT] = {
+    {"level", -1},
+    {"maze", -1},
+    {"random 0%", 0},
+    {"random 10%", 100},
+    {"random 25%", 250},
+    {"random 40%", 400}
+};
+
+typedef struct{
+    int start_x, start_y;
+    int goal_x, goal_y;
+} PathQuery;
+
+// What find_path returned for one query; length -1 if it found no path
+typedef struct{
+    int length;
+    int cost;
+    Uint32 path_hash;
+} PathResult;
+
+static World world;
+static Entity entity;
+
+static void build_map(int map, Uint64 seed) {
+    if (map == 0) {
+        load_level_map(&world);
+        return;
+    }
+    RandomStream rng;
+    init_random_stream(&rng, seed, (Uint64)map);
+    for (int y = 0; y < MAP_SIZE; y++) {
+        for (int x = 0; x < MAP_SIZE; x++) {
+            if (map == 1) world.map[y][x] = (uint8_t)maze[y][x];
+            else if (random_below(&rng, 1000) < bench_maps[map].density) world.map[y][x] = (uint8_t)(WALL_BULLETPROOF + random_below(&rng, 2));
+            else world.map[y][x] = WALL_NONE;
+        }
+    }
+}
+
+// Whether a move from one tile to a neighbour is one find_path may take: onto an open tile and,
+// diagonally, not cutting the corner of a wall
+static bool is_valid_step(int x, int y, int dx, int dy) {
+    if (!is_valid_node(x + dx, y + dy, &world)) return false;
+    if (dx != 0 && dy != 0) return is_valid_node(x + dx, y, &world) && is_valid_node(x, y + dy, &world);
+    return true;
+}
+
+// Returns the cheapest cost from start to goal, with find_path's step costs (10 straight, 14
+// diagonal), or -1 if the goal can't be reached. Dijkstra with a binary heap of (cost, tile).
+static int find_reference_cost(int start_x, int start_y, int goal_x, int goal_y) {
+    static int cost[MAP_SIZE * MAP_SIZE];
+    static int heap_cost[MAP_SIZE * MAP_SIZE * 8], heap_tile[MAP_SIZE * MAP_SIZE * 8];
+    for (int i = 0; i < MAP_SIZE * MAP_SIZE; i++) cost[i] = -1;
+    int heap_count = 0;
+    heap_cost[0] = 0;
+    heap_tile[heap_count++] = start_x + start_y * MAP_SIZE;
+    cost[start_x + start_y * MAP_SIZE] = 0;
+    while (heap_count > 0) {
+        int tile_cost = heap_cost[0], tile = heap_tile[0];
+        heap_count--;
+        int child_cost = heap_cost[heap_count], child_tile = heap_tile[heap_count];
+        int hole = 0;
+        for (int child = 1; child < heap_count; child = 2 * hole + 1) {
+            if (child + 1 < heap_count && heap_cost[child + 1] < heap_cost[child]) child++;
+            if (heap_cost[child] >= child_cost) break;
+            heap_cost[hole] = heap_cost[child];
+            heap_tile[hole] = heap_tile[child];
+            hole = child;
+        }
+        heap_cost[hole] = child_cost;
+        heap_tile[hole] = child_tile;
+
+        if (tile_cost > cost[tile]) continue; // Already reached more cheaply
+        int x = tile % MAP_SIZE, y = tile / MAP_SIZE;
+        if (x == goal_x && y == goal_y) return tile_cost;
+        for (int dy = -1; dy <= 1; dy++) {
+            for (int dx = -1; dx <= 1; dx++) {
+                if ((dx == 0 && dy == 0) || !is_valid_step(x, y, dx, dy)) continue;
+                int next = tile + dx + dy * MAP_SIZE;
+                int next_cost = tile_cost + (dx != 0 && dy != 0 ? 14 : 10);
+                if (cost[next] >= 0 && cost[next] <= next_cost) continue;
+                cost[next] = next_cost;
+                int i = heap_count++;
+                while (i > 0 && heap_cost[(i - 1) / 2] > next_cost) {
+                    heap_cost[i] = heap_cost[(i - 1) / 2];
+                    heap_tile[i] = heap_tile[(i - 1) / 2];
+                    i = (i - 1) / 2;
+                }
+                heap_cost[i] = next_cost;
+                heap_tile[i] = next;
+            }
+        }
+    }
+    return -1;
+}
+
+// Walks the path find_path left in entity, returning its cost, or -1 if it isn't a chain of valid
+// steps from the start to the goal. The path is a stack that enemies pop from the end: the start
+// tile is last, and the goal itself is left off, so the walk ends with a step onto it.
+static int get_path_cost(const PathQuery* query) {
+    if (entity.path[entity.path_length - 1] != query->start_x + query->start_y * MAP_SIZE) return -1;
+    int x = query->start_x, y = query->start_y, cost = 0;
+    for (int i = entity.path_length - 2; i >= -1; i--) {
+        int next_x = i >= 0 ? entity.path[i] % MAP_SIZE : query->goal_x;
+        int next_y = i >= 0 ? entity.path[i] / MAP_SIZE : query->goal_y;
+        int dx = next_x - x, dy = next_y - y;
+        if (dx < -1 || dx > 1 || dy < -1 || dy > 1 || (dx == 0 && dy == 0) || !is_valid_step(x, y, dx, dy)) return -1;
+        cost += dx != 0 && dy != 0 ? 14 : 10;
+        x = next_x;
+        y = next_y;
+    }
+    return cost;
+}
+
+// Picks start/goal pairs of distinct open tiles
+static void make_queries(PathQuery* queries, int count, Uint64 seed, int map) {
+    RandomStream rng;
+    init_random_stream(&rng, seed, random_stream_selector(RANDOM_INPUT, map));
+    for (int i = 0; i < count; i++) {
+        PathQuery* query = &queries[i];
+        do {
+            query->start_x = random_below(&rng, MAP_SIZE);
+            query->start_y = random_below(&rng, MAP_SIZE);
+        } while (!is_valid_node(query->start_x, query->start_y, &world));
+        do {
+            query->goal_x = random_below(&rng, MAP_SIZE);
+            query->goal_y = random_below(&rng, MAP_SIZE);
+        } while (!is_valid_node(query->goal_x, query->goal_y, &world) ||
+                 (query->goal_x == query->start_x && query->goal_y == query->start_y));
+    }
+}
+
+int main(int argc, char* argv[]) {
+    int query_count = argc > 1 ? atoi(argv[1]) : BENCH_DEFAULT_QUERIES;
+    Uint64 seed = 1;
+    if (argc > 2 && !parse_seed(argv[2], &seed)) {
+        printf("Invalid seed: %s\n", argv[2]);
+        return 1;
+    }
+    bool save = argc > 4 && my_strcmp(argv[3], "save") == 0;
+    bool check = argc > 4 && my_strcmp(argv[3], "check") == 0;
+    if (query_count <= 0 || (argc > 3 && !save && !check)) {
+        printf("Usage: %s [queries per map] [seed] [save|check <results file>]\n", argv[0]);
+        return 1;
+    }
+    FILE* results_file = NULL;
+    if (save || check) {
+        results_file = fopen(argv[4], save ? "w" : "r");
+        if (!results_file) {
+            printf("Failed to open %s\n", argv[4]);
+            return 1;
+        }
+    }
+
+    PathQuery* queries = malloc(sizeof(PathQuery) * query_count);
+    PathResult* results = malloc(sizeof(PathResult) * query_count);
+    if (!queries || !results) {
+        printf("Failed to allocate %d queries\n", query_count);
+        return 1;
+    }
+    entity.w = entity.h = TILE_SIZE / 2;
+
+    // Invalid paths, and in "check" queries whose result changed: lost (no longer found), longer,
+    // new (found where the saved run didn't), shorter, and same cost by another route
+    int invalid = 0, lost = 0, longer = 0, found_new = 0, shorter = 0, rerouted = 0, mismatches = 0;
+    const Uint64 frequency = SDL_GetPerformanceFrequency();
+    printf("%d queries per map, seed %llu\n", query_count, (unsigned long long)seed);
+    printf("%-11s %10s %9s %9s %8s %8s %9s %8s %7s\n", "map", "queries/s", "nodes/q", "found", "length",
+           "optimal", "cost/opt", "capped", "invalid");
+    for (int map = 0; map < BENCH_MAP_COUNT; map++) {
+        build_map(map, seed);
+        make_queries(queries, query_count, seed, map);
+
+        Uint64 total = 0;
+        long long nodes = 0, length_sum = 0;
+        int found = 0, optimal = 0, capped = 0, map_invalid = 0;
+        double cost_ratio = 0.0;
+        for (int i = 0; i < query_count; i++) {
+            const PathQuery* query = &queries[i];
+            entity.x = query->start_x * TILE_SIZE + TILE_SIZE / 4;
+            entity.y = query->start_y * TILE_SIZE + TILE_SIZE / 4;
+            Uint64 start = SDL_GetPerformanceCounter();
+            int expanded = find_path(&entity, &world, query->goal_x, query->goal_y);
+            total += SDL_GetPerformanceCounter() - start;
+            nodes += expanded;
+
+            PathResult* result = &results[i];
+            result->length = entity.path_length > 0 ? entity.path_length : -1;
+            result->cost = result->length > 0 ? get_path_cost(query) : 0;
+            result->path_hash = hash_bytes(2166136261u, entity.path, sizeof(int) * entity.path_length);
+            int reference = find_reference_cost(query->start_x, query->start_y, query->goal_x, query->goal_y);
+            if (result->length > 0) {
+                if (result->cost < 0 || reference < 0) {
+                    map_invalid++;
+                    continue;
+                }
+                found++;
+                length_sum += result->length;
+                optimal += result->cost == reference;
+                cost_ratio += (double)result->cost / reference;
+            } else if (reference >= 0) {
+                // Reachable but not found: fine if find_path ran out of iterations, a bug otherwise
+                if (expanded >= MAX_PATHFINDING_ITERATIONS) capped++;
+                else map_invalid++;
+            }
+        }
+        invalid += map_invalid;
+        double seconds = (double)total / frequency;
+        printf("%-11s %10.0f %9.1f %8.1f%% %8.1f %7.1f%% %9.4f %8d %7d\n", bench_maps[map].name,
+               query_count / seconds, (double)nodes / query_count, 100.0 * found / query_count,
+               found ? (double)length_sum / found : 0.0, found ? 100.0 * optimal / found : 0.0,
+               found ? cost_ratio / found : 0.0, capped, map_invalid);
+
+        for (int i = 0; i < query_count && results_file; i++) {
+            PathResult* result = &results[i];
+            if (save) {
+                fprintf(results_file, "%d %d %d %d %08x\n", map, i, result->length, result->cost, (unsigned)result->path_hash);
+                continue;
+            }
+            int saved_map, saved_query, saved_length, saved_cost;
+            unsigned saved_hash;
+            if (fscanf(results_file, "%d %d %d %d %x", &saved_map, &saved_query, &saved_length, &saved_cost, &saved_hash) != 5 ||
+                saved_map != map || saved_query != i) {
+                printf("%s doesn't match these arguments (other query count or seed?)\n", argv[4]);
+                return 1;
+            }
+            const char* change = NULL;
+            if (saved_length > 0 && result->length < 0) change = "lost", lost++;
+            else if (saved_length < 0 && result->length > 0) change = "new", found_new++;
+            else if (result->cost > saved_cost) change = "longer", longer++;
+            else if (result->cost < saved_cost) change = "shorter", shorter++;
+            else if (result->path_hash != saved_hash) rerouted++;
+            if (change && mismatches++ < BENCH_MAX_MISMATCHES) {
+                const PathQuery* query = &queries[i];
+                printf("  %s query %d, (%d, %d) to (%d, %d): %s, cost %d -> %d\n", bench_maps[map].name, i,
+                       query->start_x, query->start_y, query->goal_x, query->goal_y, change, saved_cost, result->cost);
+            }
+        }
+    }
+    if (check) {
+        printf("vs %s: %d lost, %d longer, %d newly found, %d shorter, %d same cost by another route\n", argv[4], lost,
+               longer, found_new, shorter, rerouted);
+    }
+    if (results_file) fclose(results_file);
+    free(queries);
+    free(results);
+    return invalid > 0 || lost > 0 || longer > 0;
+}
@@ -0,0 +1,191 @@
+// Benchmarks render() offscreen on SDL's software renderer, so it needs no window, display or GPU.
+// Usage: renderBench [WxH] [frames] [enemies per flag]
+// The player flies a fixed figure of eight over the level, aiming round and firing, while the
+// enemies (seeded) fight back. The first BENCH_WARMUP_FRAMES frames bake chunks and caches and
+// aren't counted. Prints one JSON object: render() time percentiles and, in profiler builds, the
+// mean time of each part of render() per frame. Run from the repository root, for the assets.
+#include "common.h"
+#include "types.h"
+#include "utils.h"
+#include "game.h"
+#include "render.h"
+#include "command.h"
+#include "menu.h"
+#include "cover.h"
+#include "influence.h"
+#include "chunks.h"
+#include "sprites.h"
+#include "text.h"
+#include "snapshot.h"
+#include "level.h"
+#include "random.h"
+#include "profiler.h"
+#include "timing.h"
+#include "memtrack.h"
+
+SDL_Texture* fov_mask = NULL;
+
+#define BENCH_DEFAULT_W 1920
+#define BENCH_DEFAULT_H 1080
+#define BENCH_DEFAULT_FRAMES 300
+#define BENCH_DEFAULT_ENEMIES_PER_FLAG 5
+#define BENCH_WARMUP_FRAMES 10
+
+static Player player;
+static World world;
+static Enemy enemies[MAX_ENEMIES];
+static Bullet bullets[MAX_BULLETS];
+static SnapshotBuffer snapshots;
+static Console console;
+static Menu menu;
+
+// Places the player on a figure of eight around the middle of the world, t going 0 to 1 per lap
+static void follow_camera_path(float t) {
+    float radius = WORLD_W * 0.35f;
+    player.x = WORLD_W / 2 + radius * my_cosf(2.0f * MA_PI * t) - player.w / 2;
+    player.y = WORLD_H / 2 + radius * 0.5f * my_sinf(4.0f * MA_PI * t) - player.h / 2;
+}
+
+int main(int argc, char* argv[]) {
+    int w = BENCH_DEFAULT_W, h = BENCH_DEFAULT_H;
+    if (argc > 1 && (sscanf(argv[1], "%dx%d", &w, &h) != 2 || w <= 0 || h <= 0)) {
+        printf("Usage: %s [WxH] [frames] [enemies per flag]\n", argv[0]);
+        return 1;
+    }
+    int frames = argc > 2 ? atoi(argv[2]) : BENCH_DEFAULT_FRAMES;
+    int enemies_per_flag = argc > 3 ? atoi(argv[3]) : BENCH_DEFAULT_ENEMIES_PER_FLAG;
+    if (frames <= 0 || enemies_per_flag < 0) {
+        printf("Frame count must be positive and enemy count not negative\n");
+        return 1;
+    }
+    if (IMG_Init(IMG_INIT_PNG) != IMG_INIT_PNG) {
+        printf("IMG_Init failed: %s\n", IMG_GetError());
+        return 1;
+    }
+    if (TTF_Init() < 0) {
+        printf("TTF_Init failed: %s\n", TTF_GetError());
+        return 1;
+    }
+
+    SDL_Surface* surface = SDL_CreateRGBSurfaceWithFormat(0, w, h, 32, SDL_PIXELFORMAT_RGBA8888);
+    if (!surface) {
+        printf("SDL_CreateRGBSurfaceWithFormat failed: %s\n", SDL_GetError());
+        return 1;
+    }
+    SDL_Renderer* renderer = SDL_CreateSoftwareRenderer(surface);
+    if (!renderer) {
+        printf("SDL_CreateSoftwareRenderer failed: %s\n", SDL_GetError());
+        return 1;
+    }
+    TTF_Font* font = TTF_OpenFont("assets/fonts/Google_Sans_Code/GoogleSansCode-VariableFont_wght.ttf", 16);
+    SDL_Texture* player_texture = load_texture("assets/images/16x16PlayerG.png", renderer);
+    SDL_Texture* enemy_texture = load_texture("assets/images/16x16PlayerP.png", renderer);
+    SDL_Texture* grass_texture = load_texture("assets/images/16x16Grass.png", renderer);
+    SDL_Texture* wall_texture_S = load_texture("assets/images/16x16SWall.png", renderer);
+    SDL_Texture* wall_texture_B = load_texture("assets/images/16x16Wall.png", renderer);
+    SDL_Texture* wall_texture_O = load_texture("assets/images/16x16BWall.png", renderer);
+    SDL_Texture* flag_texture = load_texture("assets/images/8x8FlagP.png", renderer);
+    if (!font || !player_texture || !enemy_texture || !grass_texture || !wall_texture_S || !wall_texture_B || !wall_texture_O || !flag_texture) {
+        printf("Failed to load assets - run from the repository root\n");
+        return 1;
+    }
+
+    // The same world as the game's, drawn through the same atlases and chunk textures
+    const char* const sprite_paths[SPRITE_COUNT] = {
+        "assets/images/16x16PlayerG.png",
+        "assets/images/16x16PlayerP.png",
+        "assets/images/16x16Grass.png",
+        "assets/images/16x16SWall.png",
+        "assets/images/16x16Wall.png",
+        "assets/images/16x16BWall.png",
+        "assets/images/8x8FlagP.png"
+    };
+    if (!build_sprite_atlas(&world.atlas, renderer, sprite_paths)) printf("Sprite atlas unavailable, drawing sprites one by one\n");
+    if (!build_glyph_atlas(&world.glyphs, renderer, font)) printf("Glyph atlas unavailable, text will not be drawn\n");
+    world.background = create_background_texture(renderer, grass_texture, WORLD_W, WORLD_H);
+    if (!world.background) {
+        printf("Failed to create background texture\n");
+        return 1;
+    }
+    load_level_map(&world);
+    init_walls(&world, renderer, wall_texture_S, wall_texture_B, wall_texture_O);
+    build_cover_index(&world);
+    init_influence_map(&world);
+    init_map_chunks(&world, renderer);
+    if (!init_flags(&world, enemies_per_flag, flag_texture)) return 1;
+    world.fps = 60.0f;
+
+    GameState game_state = {true, false, true};
+    player = (Player){0, 0, 48, 48, 0, 0, 0, player_texture, 0, 0, 0};
+    follow_camera_path(0.0f);
+    Camera camera = {0, 0, w, h};
+    center_camera(&camera, &player, &world);
+    for (int i = 0; i < MAX_ENEMIES; i++) {
+        enemies[i].texture = enemy_texture;
+        enemies[i].flag_id = -1;
+    }
+    seed_enemy_random(enemies, 1);
+    int spawned = spawn_flag_enemies(&world, enemies, &camera);
+    init_console(&console);
+    init_menu(&menu, renderer, &world.glyphs, &game_state);
+    SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
+    init_snapshot_buffer(&snapshots);
+
+    double zone_ms[PROFILE_ZONE_COUNT] = {0};
+    PlayerInput input = {0};
+    for (int frame = 0; frame < BENCH_WARMUP_FRAMES + frames; frame++) {
+        // One fixed update per frame, untimed, so there is something moving to draw
+        follow_camera_path((float)frame / (BENCH_WARMUP_FRAMES + frames));
+        input.aim = true;
+        input.angle = (float)(frame * 3 % 360);
+        input.fire = frame % 8 == 0;
+        save_previous_transforms(&player, enemies, bullets);
+        apply_player_input(&player, &world, bullets, &input);
+        fixed_update_enemies(&player, &world, bullets, enemies, &camera, &game_state);
+        publish_render_snapshot(&snapshots, &player, &world, enemies, bullets);
+        const RenderSnapshot* snap = acquire_render_snapshot(&snapshots);
+        Player player_view = interpolate_player(&snap->player, 1.0f);
+        update_camera(&camera, &player_view, &world, renderer);
+
+        Uint64 start = SDL_GetPerformanceCounter();
+        render(renderer, snap, &player_view, 1.0f, FIXED_DT, &camera, &world, &console, &game_state, &menu);
+        Uint64 end = SDL_GetPerformanceCounter();
+        profile_end_frame();
+        if (frame < BENCH_WARMUP_FRAMES) continue;
+        record_timing(TIMING_RENDER, start, end);
+        const ProfileFrame* profile = get_profile_frame(0);
+        for (int i = 0; i < PROFILE_ZONE_COUNT; i++) zone_ms[i] += profile->zone_ms[i];
+    }
+
+    TimingSummary s;
+    get_timing_summary(TIMING_RENDER, &s);
+    printf("{\"bench\":\"render\",\"renderer\":\"software\",\"width\":%d,\"height\":%d,\"frames\":%d,\"enemies\":%d,", w, h,
+           frames, spawned);
+    printf("\"render_ms\":{\"mean\":%.4f,\"p50\":%.4f,\"p90\":%.4f,\"p99\":%.4f,\"max\":%.4f},", s.mean_ms, s.p50_ms,
+           s.p90_ms, s.p99_ms, s.max_ms);
+#ifdef ENABLE_PROFILER
+    printf("\"zones_ms\":{");
+    for (int i = PROFILE_RENDER_MAP; i <= PROFILE_PRESENT; i++) {
+        printf("%s\"%s\":%.4f", i > PROFILE_RENDER_MAP ? "," : "", get_profile_zone_name(i), zone_ms[i] / frames);
+    }
+    printf("}}\n");
+#else
+    printf("\"zones_ms\":null}\n");
+#endif
+
+    free_map_chunks(&world);
+    free_sprite_atlas(&world.atlas);
+    free_glyph_atlas(&world.glyphs);
+    free_cover_index(&world);
+    free_influence_map(&world);
+    my_free(world.flags);
+    my_free(world.walls);
+    destroy_tracked_texture(fov_mask);
+    destroy_tracked_texture(world.background);
+    SDL_DestroyRenderer(renderer);
+    SDL_FreeSurface(surface);
+    TTF_CloseFont(font);
+    TTF_Quit();
+    IMG_Quit();
+    return 0;
+}
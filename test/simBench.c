@@ -0,0 +1,181 @@
+// Runs the simulation headless: no window, renderer or font, just the world, flags, enemies
+// and bullets ticked as fast as possible with a scripted or random player.
+// Usage: simBench <enemies> [ticks] [script|random] [seed] [timings file]
+// Prints ticks per second, where each tick's time went, tick-time percentiles (also written to the
+// timings file, as CSV or JSON) and a checksum of the final state, which is the same on every run
+// with the same arguments.
+#include "common.h"
+#include "types.h"
+#include "utils.h"
+#include "game.h"
+#include "cover.h"
+#include "influence.h"
+#include "level.h"
+#include "snapshot.h"
+#include "random.h"
+#include "profiler.h"
+#include "timing.h"
+#include "memtrack.h"
+
+SDL_Texture* fov_mask = NULL;
+
+#define BENCH_DEFAULT_TICKS 600
+
+static Player player;
+static World world;
+static Enemy enemies[MAX_ENEMIES];
+static Bullet bullets[MAX_BULLETS];
+static SnapshotBuffer snapshots;
+
+static RandomStream input_random;
+
+// Walks a square around the middle of the map, sweeping its aim and firing four times a second
+static void script_input(PlayerInput* input, int tick) {
+    float t = tick * fixed_dt;
+    int leg = (int)(t / 2.0f) % 4;
+    const float legs[4][2] = {{1, 0}, {0, 1}, {-1, 0}, {0, -1}};
+    input->move_x = legs[leg][0];
+    input->move_y = legs[leg][1];
+    input->aim = true;
+    input->angle = (float)((int)(t * 90.0f) % 360);
+    input->fire = (int)(t * 4.0f) != (int)((t - fixed_dt) * 4.0f);
+}
+
+// Picks a new direction and aim every half second and fires at random
+static void random_input(PlayerInput* input, int tick) {
+    int hold = (int)(0.5f / fixed_dt);
+    if (hold < 1) hold = 1;
+    if (tick % hold == 0) {
+        input->move_x = (float)(random_below(&input_random, 3) - 1);
+        input->move_y = (float)(random_below(&input_random, 3) - 1);
+        input->aim = true;
+        input->angle = (float)random_below(&input_random, 360);
+    }
+    input->fire = random_below(&input_random, 16) == 0;
+}
+
+// Hashes the state that matters, to tell runs apart
+static Uint32 hash_simulation(void) {
+    Uint32 hash = 2166136261u;
+    hash = hash_bytes(hash, &player.x, sizeof(player.x));
+    hash = hash_bytes(hash, &player.y, sizeof(player.y));
+    for (int i = 0; i < MAX_ENEMIES; i++) {
+        if (!enemies[i].active) continue;
+        hash = hash_bytes(hash, &i, sizeof(i));
+        hash = hash_bytes(hash, &enemies[i].x, sizeof(enemies[i].x));
+        hash = hash_bytes(hash, &enemies[i].y, sizeof(enemies[i].y));
+        hash = hash_bytes(hash, &enemies[i].angle, sizeof(enemies[i].angle));
+        hash = hash_bytes(hash, &enemies[i].hp, sizeof(enemies[i].hp));
+        hash = hash_bytes(hash, &enemies[i].state, sizeof(enemies[i].state));
+    }
+    for (int i = 0; i < MAX_BULLETS; i++) {
+        if (!bullets[i].active) continue;
+        hash = hash_bytes(hash, &bullets[i].x, sizeof(bullets[i].x));
+        hash = hash_bytes(hash, &bullets[i].y, sizeof(bullets[i].y));
+    }
+    return hash;
+}
+
+int main(int argc, char* argv[]) {
+    mark_stack_base();
+    if (argc < 2) {
+        printf("Usage: %s <enemies> [ticks] [script|random] [seed] [timings file]\n", argv[0]);
+        return 1;
+    }
+    int enemy_count = atoi(argv[1]);
+    int ticks = argc > 2 ? atoi(argv[2]) : BENCH_DEFAULT_TICKS;
+    bool random_player = argc > 3 && my_strcmp(argv[3], "random") == 0;
+    Uint64 seed = 1;
+    if (argc > 4 && !parse_seed(argv[4], &seed)) {
+        printf("Invalid seed: %s\n", argv[4]);
+        return 1;
+    }
+    if (enemy_count < 0 || enemy_count > MAX_ENEMIES) {
+        printf("Enemy count must be between 0 and MAX_ENEMIES (%d)\n", MAX_ENEMIES);
+        return 1;
+    }
+    if (ticks <= 0) {
+        printf("Tick count must be positive\n");
+        return 1;
+    }
+    init_random_stream(&input_random, seed, random_stream_selector(RANDOM_INPUT, 0));
+
+    // Same level as the game, minus everything that needs a renderer
+    load_level_map(&world);
+    init_walls(&world, NULL, NULL, NULL, NULL);
+    build_cover_index(&world);
+    init_influence_map(&world);
+    if (!init_flags(&world, 0, NULL)) return 1;
+    for (int i = 0; i < world.flag_count; i++) {
+        // Split the crowd over the flags, the first ones taking any remainder
+        world.flags[i].enemy_count = enemy_count / world.flag_count + (i < enemy_count % world.flag_count);
+    }
+
+    player = (Player){WORLD_W / 2, WORLD_H / 2, 48, 48, 0, 0, 0, NULL, WORLD_W / 2, WORLD_H / 2, 0};
+    Camera camera = {0, 0, CAMERA_W, CAMERA_H};
+    center_camera(&camera, &player, &world);
+    for (int i = 0; i < MAX_ENEMIES; i++) enemies[i].flag_id = -1;
+    seed_enemy_random(enemies, seed);
+    GameState game_state = {false, false, true};
+    int spawned = spawn_flag_enemies(&world, enemies, &camera);
+    init_snapshot_buffer(&snapshots);
+
+    // Every tick closes a profiler frame, whose zones are summed here
+    double zone_ms[PROFILE_ZONE_COUNT] = {0};
+    PlayerInput input = {0};
+
+    const Uint64 frequency = SDL_GetPerformanceFrequency();
+    Uint64 start = SDL_GetPerformanceCounter();
+    for (int tick = 0; tick < ticks; tick++) {
+        Uint64 tick_start = SDL_GetPerformanceCounter();
+        if (random_player) random_input(&input, tick);
+        else script_input(&input, tick);
+
+        center_camera(&camera, &player, &world);
+        save_previous_transforms(&player, enemies, bullets);
+        apply_player_input(&player, &world, bullets, &input);
+        fixed_update_enemies(&player, &world, bullets, enemies, &camera, &game_state);
+
+        // Published every tick, i.e. as if a frame were drawn after each one
+        publish_render_snapshot(&snapshots, &player, &world, enemies, bullets);
+        record_timing(TIMING_TICK, tick_start, SDL_GetPerformanceCounter());
+
+        profile_end_frame();
+        const ProfileFrame* frame = get_profile_frame(0);
+        for (int i = 0; i < PROFILE_ZONE_COUNT; i++) zone_ms[i] += frame->zone_ms[i];
+    }
+    Uint64 total = SDL_GetPerformanceCounter() - start;
+
+    int active = 0;
+    for (int i = 0; i < MAX_ENEMIES; i++) active += enemies[i].active;
+    double seconds = (double)total / frequency;
+    printf("%d enemies (%d spawned, %d active at the end), %d ticks at %d Hz, %s player, seed %llu\n",
+           enemy_count, spawned, active, ticks, (int)(1.0f / fixed_dt + 0.5f), random_player ? "random" : "scripted",
+           (unsigned long long)seed);
+    printf("%.1f ticks/sec, %.3f ms/tick\n", ticks / seconds, seconds * 1000.0 / ticks);
+
+#ifdef ENABLE_PROFILER
+    // The zones up to the snapshot are the simulation's. They are inclusive: enemies contains
+    // decisions, which contains find_path.
+    double total_ms = seconds * 1000.0, top_level_ms = 0.0;
+    printf("  %-16s %10s %7s\n", "zone", "ms/tick", "share");
+    for (int i = 0; i <= PROFILE_SNAPSHOT; i++) {
+        int depth = get_profile_zone_depth(i);
+        if (depth == 0) top_level_ms += zone_ms[i];
+        printf("  %*s%-*s %10.4f %6.1f%%\n", 2 * depth, "", 16 - 2 * depth, get_profile_zone_name(i),
+               zone_ms[i] / ticks, 100.0 * zone_ms[i] / total_ms);
+    }
+    double other_ms = total_ms > top_level_ms ? total_ms - top_level_ms : 0.0;
+    printf("  %-16s %10.4f %6.1f%%\n", "other", other_ms / ticks, 100.0 * other_ms / total_ms);
+#else
+    printf("  built with PROFILE=0, no per-zone timings\n");
+#endif
+    print_timing_report();
+    print_memory_report();
+    if (argc > 5 && !write_timing_report(argv[5])) return 1;
+    printf("state checksum %08x\n", (unsigned)hash_simulation());
+
+    my_free(world.flags);
+    my_free(world.walls);
+    return 0;
+}